@@ -0,0 +1,85 @@
+#include "compact_splay_tree.h"
+#include "splay_tree.h"
+#include "bench_utils.h"
+#include <benchmark/benchmark.h>
+
+#include <vector>
+#include <cstdint>
+
+
+// Lookups of uniformly random keys after n inserts and n random erase + insert pairs,
+// which scatter neighbouring nodes over memory
+// Args: number of elements[, layout: 0 - as is, 1 - in-order, 2 - van Emde Boas]
+
+template<class Tree>
+static std::vector<int64_t> churn(Tree& tree, size_t n)
+{
+    std::vector<int64_t> keys = make_uniform_trace(n, (size_t)1 << 62, 1);
+    std::vector<int64_t> fresh = make_uniform_trace(n, (size_t)1 << 62, 2);
+    std::vector<int64_t> victims = make_uniform_trace(n, n, 3);
+
+    for (int64_t key : keys)
+        tree.insert(std::make_pair(key, key));
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        int64_t& victim = keys[victims[i]];
+
+        tree.erase(victim);
+        victim = fresh[i];
+        tree.insert(std::make_pair(victim, victim));
+    }
+
+    return keys;
+}
+
+template<class Tree>
+static void run_lookups(benchmark::State& state, Tree& tree, const std::vector<int64_t>& keys)
+{
+    auto trace = make_uniform_trace(1 << 20, keys.size(), 4);
+
+    for (auto _ : state)
+    {
+        for (int64_t i : trace)
+            benchmark::DoNotOptimize(tree.find(keys[i]));
+    }
+
+    state.SetItemsProcessed(state.iterations() * trace.size());
+}
+
+static void BM_CompactSplayTreeFind(benchmark::State& state)
+{
+    const size_t n = state.range(0);
+
+    compact_splay_tree<int64_t, int64_t> tree;
+    tree.reserve(n);
+
+    auto keys = churn(tree, n);
+
+    if (state.range(1) == 1)
+        tree.relayout(layout_order::in_order);
+    else if (state.range(1) == 2)
+        tree.relayout(layout_order::van_emde_boas);
+
+    run_lookups(state, tree, keys);
+
+    // 32-bit parent, children and size
+    state.counters["link_bytes_per_node"] = 4 * sizeof(uint32_t);
+}
+
+static void BM_PointerSplayTreeFind(benchmark::State& state)
+{
+    const size_t n = state.range(0);
+
+    splay_tree<int64_t, int64_t> tree;
+
+    auto keys = churn(tree, n);
+
+    run_lookups(state, tree, keys);
+
+    // value pointer, parent, children and size
+    state.counters["link_bytes_per_node"] = 5 * sizeof(void*);
+}
+
+BENCHMARK(BM_CompactSplayTreeFind)->ArgsProduct({ { 1 << 16, 1 << 20, 1 << 24 }, { 0, 1, 2 } })->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_PointerSplayTreeFind)->Arg(1 << 16)->Arg(1 << 20)->Arg(1 << 24)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,140 @@
+#include "concurrent_splay_map.h"
+#include "bench_utils.h"
+#include <benchmark/benchmark.h>
+
+#include <mutex>
+#include <random>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+
+// 90% finds, 5% inserts and 5% erases from every thread
+// Args: distribution (0 - uniform keys, 1 - 90% of keys in the first 1/64 of the key space)[, rebalance by a workload sample]
+
+static const size_t key_space = 1 << 20;
+static const size_t initial_shards = 16;
+
+static std::vector<int64_t> make_thread_trace(int distribution, uint64_t seed)
+{
+    std::vector<int64_t> trace = make_uniform_trace(1 << 16, key_space, seed);
+
+    if (distribution == 1)
+    {
+        std::mt19937_64 rng(seed);
+        for (auto& key : trace)
+            if (rng() % 10 != 0)
+                key %= key_space / 64;
+    }
+
+    return trace;
+}
+
+// Single splay tree behind one mutex
+class global_lock_splay_map
+{
+public:
+    bool insert(const std::pair<const int64_t, int64_t>& value) { std::lock_guard<std::mutex> lock(mutex); return tree.insert(value).second; }
+    size_t erase(int64_t key) { std::lock_guard<std::mutex> lock(mutex); return tree.erase(key); }
+    bool find(int64_t key, int64_t& value)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        auto it = tree.find(key);
+        if (it == tree.end())
+            return false;
+
+        value = it->second;
+        return true;
+    }
+
+private:
+    std::mutex mutex;
+    splay_tree<int64_t, int64_t> tree;
+};
+
+template<class Map>
+static void run_mixed_ops(benchmark::State& state, Map& map)
+{
+    auto trace = make_thread_trace((int)state.range(0), 100 + state.thread_index());
+
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < trace.size(); ++i)
+        {
+            int64_t key = trace[i];
+            int64_t value;
+
+            if (i % 20 == 0)
+                map.insert(std::make_pair(key, key));
+            else if (i % 20 == 1)
+                map.erase(key);
+            else
+                benchmark::DoNotOptimize(map.find(key, value));
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * trace.size());
+}
+
+template<class Map>
+static void fill(Map& map)
+{
+    for (int64_t key : make_uniform_trace(key_space / 2, key_space, 1))
+        map.insert(std::make_pair(key, key));
+}
+
+static std::unique_ptr<concurrent_splay_map<int64_t, int64_t>> sharded_map;
+static std::unique_ptr<global_lock_splay_map> global_map;
+
+static void BM_ConcurrentSplayMapMixed(benchmark::State& state)
+{
+    if (state.thread_index() == 0)
+    {
+        std::vector<int64_t> split_keys;
+        for (size_t i = 1; i < initial_shards; ++i)
+            split_keys.push_back((int64_t)(i * key_space / initial_shards));
+
+        sharded_map = std::make_unique<concurrent_splay_map<int64_t, int64_t>>(split_keys);
+        fill(*sharded_map);
+        sharded_map->rebalance();
+
+        // rebalance after a sample of the workload, so hot ranges get their own shards
+        if (state.range(1) == 1)
+        {
+            for (int round = 0; round < 4; ++round)
+            {
+                int64_t value;
+                for (int64_t key : make_thread_trace((int)state.range(0), 7))
+                    sharded_map->find(key, value);
+
+                sharded_map->rebalance(1.0);
+            }
+        }
+    }
+
+    run_mixed_ops(state, *sharded_map);
+
+    if (state.thread_index() == 0)
+    {
+        state.counters["shards"] = (double)sharded_map->shard_count();
+        sharded_map.reset();
+    }
+}
+
+static void BM_GlobalLockSplayTreeMixed(benchmark::State& state)
+{
+    if (state.thread_index() == 0)
+    {
+        global_map = std::make_unique<global_lock_splay_map>();
+        fill(*global_map);
+    }
+
+    run_mixed_ops(state, *global_map);
+
+    if (state.thread_index() == 0)
+        global_map.reset();
+}
+
+BENCHMARK(BM_ConcurrentSplayMapMixed)->ArgsProduct({ { 0, 1 }, { 0, 1 } })->ThreadRange(1, 8)->UseRealTime()->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_GlobalLockSplayTreeMixed)->Arg(0)->Arg(1)->ThreadRange(1, 8)->UseRealTime()->Unit(benchmark::kMillisecond);
@@ -0,0 +1,93 @@
+#include "frozen_splay_tree.h"
+#include "bench_utils.h"
+#include <benchmark/benchmark.h>
+
+#include <map>
+#include <vector>
+#include <cstdint>
+
+
+// Lookups of uniformly random keys (half of them are missing)
+// Args: number of elements
+
+static std::vector<std::pair<int64_t, int64_t>> make_sorted_elements(size_t n)
+{
+    std::vector<std::pair<int64_t, int64_t>> elements(n);
+    for (size_t i = 0; i < n; ++i)
+        elements[i] = { (int64_t)(2 * i), (int64_t)i };
+
+    return elements;
+}
+
+static void BM_FrozenSplayTreeFind(benchmark::State& state)
+{
+    const size_t n = state.range(0);
+
+    auto elements = make_sorted_elements(n);
+    frozen_splay_tree frozen(splay_tree<int64_t, int64_t>(elements.begin(), elements.end()));
+    auto trace = make_uniform_trace(1 << 16, 2 * n);
+
+    for (auto _ : state)
+    {
+        for (int64_t key : trace)
+            benchmark::DoNotOptimize(frozen.find(key));
+    }
+
+    state.SetItemsProcessed(state.iterations() * trace.size());
+}
+
+static void BM_FrozenSplayTreeLowerBound(benchmark::State& state)
+{
+    const size_t n = state.range(0);
+
+    auto elements = make_sorted_elements(n);
+    frozen_splay_tree frozen(splay_tree<int64_t, int64_t>(elements.begin(), elements.end()));
+    auto trace = make_uniform_trace(1 << 16, 2 * n);
+
+    for (auto _ : state)
+    {
+        for (int64_t key : trace)
+            benchmark::DoNotOptimize(frozen.lower_bound(key));
+    }
+
+    state.SetItemsProcessed(state.iterations() * trace.size());
+}
+
+static void BM_LiveSplayTreeFind(benchmark::State& state)
+{
+    const size_t n = state.range(0);
+
+    auto elements = make_sorted_elements(n);
+    splay_tree<int64_t, int64_t> tree(elements.begin(), elements.end());
+    auto trace = make_uniform_trace(1 << 16, 2 * n);
+
+    for (auto _ : state)
+    {
+        for (int64_t key : trace)
+            benchmark::DoNotOptimize(tree.find(key));
+    }
+
+    state.SetItemsProcessed(state.iterations() * trace.size());
+}
+
+static void BM_StdMapFind(benchmark::State& state)
+{
+    const size_t n = state.range(0);
+
+    auto elements = make_sorted_elements(n);
+    std::map<int64_t, int64_t> tree(elements.begin(), elements.end());
+    auto trace = make_uniform_trace(1 << 16, 2 * n);
+
+    for (auto _ : state)
+    {
+        for (int64_t key : trace)
+            benchmark::DoNotOptimize(tree.find(key));
+    }
+
+    state.SetItemsProcessed(state.iterations() * trace.size());
+}
+
+BENCHMARK(BM_FrozenSplayTreeFind)->RangeMultiplier(32)->Range(1 << 10, 1 << 25);
+BENCHMARK(BM_FrozenSplayTreeLowerBound)->RangeMultiplier(32)->Range(1 << 10, 1 << 25);
+BENCHMARK(BM_LiveSplayTreeFind)->RangeMultiplier(32)->Range(1 << 10, 1 << 25);
+BENCHMARK(BM_StdMapFind)->RangeMultiplier(32)->Range(1 << 10, 1 << 25);
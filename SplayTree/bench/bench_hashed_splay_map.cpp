@@ -0,0 +1,70 @@
+#include "hashed_splay_map.h"
+#include "bench_utils.h"
+#include <benchmark/benchmark.h>
+
+#include <vector>
+#include <cstdint>
+
+
+// 20 point lookups per ordered scan of 16 elements, keys drawn from Zipfian (or uniform for skew 0) distribution
+// Args: number of elements, Zipf skew * 100
+
+static std::vector<int64_t> make_trace(benchmark::State& state)
+{
+    const size_t n = state.range(0);
+    const double skew = state.range(1) / 100.0;
+
+    return (skew == 0.0) ? make_uniform_trace(1 << 20, n) : make_zipf_trace(1 << 20, n, skew);
+}
+
+template<class Map, class Find>
+static void run_mixed_trace(benchmark::State& state, Map& map, Find find)
+{
+    const size_t n = state.range(0);
+
+    for (size_t i = 0; i < n; ++i)
+        map.insert(std::make_pair((int64_t)i, (int64_t)i));
+
+    auto trace = make_trace(state);
+
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i < trace.size(); ++i)
+        {
+            if (i % 21 != 20)
+            {
+                benchmark::DoNotOptimize(find(map, trace[i]));
+                continue;
+            }
+
+            auto it = map.lower_bound(trace[i]);
+            for (size_t j = 0; j < 16 && it != map.end(); ++j, ++it)
+                benchmark::DoNotOptimize(it->second);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * trace.size());
+}
+
+static void BM_HashedSplayMapMixed(benchmark::State& state)
+{
+    hashed_splay_map<int64_t, int64_t> map;
+
+    run_mixed_trace(state, map, [](hashed_splay_map<int64_t, int64_t>& m, int64_t key) { return m.find(key); });
+
+    // splay tree node: value pointer, 3 links and size, plus separately allocated value
+    const double node_bytes = 5 * sizeof(void*) + sizeof(std::pair<const int64_t, int64_t>);
+
+    state.counters["index_bytes_per_element"] = (double)map.index_bytes() / (double)map.size();
+    state.counters["memory_overhead"] = (double)map.index_bytes() / ((double)map.size() * node_bytes);
+}
+
+static void BM_SplayTreeMixed(benchmark::State& state)
+{
+    splay_tree<int64_t, int64_t> tree;
+
+    run_mixed_trace(state, tree, [](splay_tree<int64_t, int64_t>& t, int64_t key) { return t.find(key); });
+}
+
+BENCHMARK(BM_HashedSplayMapMixed)->ArgsProduct({ { 1 << 10, 1 << 16, 1 << 22 }, { 0, 80, 120 } })->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SplayTreeMixed)->ArgsProduct({ { 1 << 10, 1 << 16, 1 << 22 }, { 0, 80, 120 } })->Unit(benchmark::kMillisecond);
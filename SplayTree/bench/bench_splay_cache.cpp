@@ -0,0 +1,103 @@
+#include "splay_cache.h"
+#include "bench_utils.h"
+#include <benchmark/benchmark.h>
+
+#include <list>
+#include <unordered_map>
+#include <cstdint>
+
+
+// Classic LRU cache: hash map from key to the position in the recency list
+template<class Key, class T>
+class hash_lru_cache
+{
+public:
+    hash_lru_cache(size_t capacity) : capacity(capacity) {}
+
+    T* get(const Key& key)
+    {
+        auto it = index.find(key);
+
+        if (it == index.end())
+            return nullptr;
+
+        lru.splice(lru.begin(), lru, it->second);
+
+        return &it->second->second;
+    }
+
+    void put(const Key& key, const T& value)
+    {
+        auto it = index.find(key);
+
+        if (it != index.end())
+        {
+            it->second->second = value;
+            lru.splice(lru.begin(), lru, it->second);
+
+            return;
+        }
+
+        lru.emplace_front(key, value);
+        index[key] = lru.begin();
+
+        if (lru.size() > capacity)
+        {
+            index.erase(lru.back().first);
+            lru.pop_back();
+        }
+    }
+
+private:
+    size_t capacity;
+
+    std::list<std::pair<Key, T>> lru;
+    std::unordered_map<Key, typename std::list<std::pair<Key, T>>::iterator> index;
+};
+
+
+// Read-through cache over Zipfian trace: get, on miss put
+// Args: cache capacity, Zipf skew * 100
+template<class Cache>
+static void run_zipf_trace(benchmark::State& state)
+{
+    const size_t capacity = state.range(0);
+    const double skew = state.range(1) / 100.0;
+    const size_t key_space = 100 * capacity;
+
+    auto trace = make_zipf_trace(1 << 20, key_space, skew);
+
+    size_t hits = 0, lookups = 0;
+
+    for (auto _ : state)
+    {
+        Cache cache(capacity);
+
+        for (int64_t key : trace)
+        {
+            if (cache.get(key) != nullptr)
+                ++hits;
+            else
+                cache.put(key, key);
+        }
+
+        lookups += trace.size();
+    }
+
+    state.SetItemsProcessed(lookups);
+    state.counters["hit_rate"] = (double)hits / (double)lookups;
+    state.counters["time_per_lookup"] = benchmark::Counter((double)lookups, benchmark::Counter::kIsRate | benchmark::Counter::kInvert);
+}
+
+static void BM_SplayCacheZipf(benchmark::State& state)
+{
+    run_zipf_trace<splay_cache<int64_t, int64_t>>(state);
+}
+
+static void BM_HashLRUCacheZipf(benchmark::State& state)
+{
+    run_zipf_trace<hash_lru_cache<int64_t, int64_t>>(state);
+}
+
+BENCHMARK(BM_SplayCacheZipf)->ArgsProduct({ { 1 << 10, 1 << 14 }, { 60, 90, 120 } })->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_HashLRUCacheZipf)->ArgsProduct({ { 1 << 10, 1 << 14 }, { 60, 90, 120 } })->Unit(benchmark::kMillisecond);
@@ -0,0 +1,98 @@
+#include "splay_tree.h"
+#include "bench_utils.h"
+#include <benchmark/benchmark.h>
+
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <cstdint>
+
+
+// Lookups of existing keys in a tree of 2^20 elements for every splaying policy
+// Args: Zipf skew * 100 (0 - uniform keys)
+// For a policy that counts accesses the trace is run once and the tree is rebuilt by optimize() before timing
+// For a policy that collects stats the mean depth of accessed nodes is reported
+template<class SplayPolicy>
+static void run_policy_lookups(benchmark::State& state)
+{
+    const size_t n = 1 << 20;
+    const double skew = state.range(0) / 100.0;
+
+    std::vector<int64_t> keys(n);
+    for (size_t i = 0; i < n; ++i)
+        keys[i] = (int64_t)i;
+    std::shuffle(keys.begin(), keys.end(), std::mt19937_64(7));
+
+    auto trace = (skew == 0) ? make_uniform_trace(1 << 18, n) : make_zipf_trace(1 << 18, n, skew);
+
+    // inserts in random order leave the tree in a typical (not perfectly balanced) shape
+    splay_tree<int64_t, int64_t, std::less<>, SplayPolicy> tree;
+    for (int64_t key : keys)
+        tree.insert(std::make_pair(key, key));
+
+    if constexpr (SplayPolicy::count_accesses)
+    {
+        for (int64_t key : trace)
+            tree.find(key);
+
+        tree.optimize();
+    }
+
+    tree.reset_rotations();
+    tree.reset_stats();
+
+    size_t lookups = 0;
+
+    for (auto _ : state)
+    {
+        for (int64_t key : trace)
+            benchmark::DoNotOptimize(tree.find(key));
+
+        lookups += trace.size();
+    }
+
+    state.SetItemsProcessed(lookups);
+    state.counters["rotations_per_lookup"] = (double)tree.rotations() / (double)lookups;
+
+    if constexpr (SplayPolicy::collect_stats)
+        state.counters["mean_depth"] = tree.stats().mean_depth();
+}
+
+static void BM_FullSplayFind(benchmark::State& state)
+{
+    run_policy_lookups<full_splay_policy>(state);
+}
+
+static void BM_SemiSplayFind(benchmark::State& state)
+{
+    run_policy_lookups<semi_splay_policy>(state);
+}
+
+static void BM_DepthThresholdSplayFind(benchmark::State& state)
+{
+    run_policy_lookups<depth_threshold_splay_policy>(state);
+}
+
+static void BM_SampledSplayFind(benchmark::State& state)
+{
+    run_policy_lookups<sampled_splay_policy>(state);
+}
+
+// Weight-balanced static tree built from access counts, lookups don't splay
+static void BM_OptimizedFind(benchmark::State& state)
+{
+    run_policy_lookups<counting_splay_policy<>>(state);
+}
+
+// Full splay with statistics collection, to compare with BM_FullSplayFind
+static void BM_StatsFullSplayFind(benchmark::State& state)
+{
+    run_policy_lookups<stats_splay_policy<>>(state);
+}
+
+BENCHMARK(BM_FullSplayFind)->Arg(0)->Arg(80)->Arg(120)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SemiSplayFind)->Arg(0)->Arg(80)->Arg(120)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_DepthThresholdSplayFind)->Arg(0)->Arg(80)->Arg(120)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SampledSplayFind)->Arg(0)->Arg(80)->Arg(120)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_OptimizedFind)->Arg(0)->Arg(80)->Arg(120)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_StatsFullSplayFind)->Arg(0)->Arg(80)->Arg(120)->Unit(benchmark::kMillisecond);
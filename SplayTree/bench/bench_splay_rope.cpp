@@ -0,0 +1,158 @@
+#include "splay_rope.h"
+#include "bench_utils.h"
+#include <benchmark/benchmark.h>
+
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <cstdint>
+
+
+// Editing of a sequence of 1M elements at uniformly random positions
+// Every benchmark reports operations per second
+
+static const size_t sequence_size = 1 << 20;
+
+static std::vector<int64_t> make_positions(size_t n)
+{
+    return make_uniform_trace(n, sequence_size);
+}
+
+// insert at a random position and erase at another one, the size doesn't change
+template<class Sequence>
+static void run_insert_erase(benchmark::State& state, Sequence& seq)
+{
+    auto positions = make_positions(1 << 12);
+
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i + 1 < positions.size(); i += 2)
+        {
+            seq.insert(seq.begin() + positions[i], (int64_t)i);
+            seq.erase(seq.begin() + positions[i + 1]);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * positions.size());
+}
+
+static void BM_SplayRopeInsertErase(benchmark::State& state)
+{
+    std::vector<int64_t> values(sequence_size);
+    splay_rope<int64_t> rope(values.begin(), values.end());
+
+    auto positions = make_positions(1 << 12);
+
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i + 1 < positions.size(); i += 2)
+        {
+            rope.insert_at(positions[i], (int64_t)i);
+            rope.erase_at(positions[i + 1]);
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * positions.size());
+}
+
+static void BM_VectorInsertErase(benchmark::State& state)
+{
+    std::vector<int64_t> seq(sequence_size);
+
+    run_insert_erase(state, seq);
+}
+
+static void BM_DequeInsertErase(benchmark::State& state)
+{
+    std::deque<int64_t> seq(sequence_size);
+
+    run_insert_erase(state, seq);
+}
+
+// access at a random position
+static void BM_SplayRopeAt(benchmark::State& state)
+{
+    std::vector<int64_t> values(sequence_size);
+    splay_rope<int64_t> rope(values.begin(), values.end());
+
+    auto positions = make_positions(1 << 16);
+
+    for (auto _ : state)
+    {
+        for (int64_t pos : positions)
+            benchmark::DoNotOptimize(rope.at(pos));
+    }
+
+    state.SetItemsProcessed(state.iterations() * positions.size());
+}
+
+static void BM_VectorAt(benchmark::State& state)
+{
+    std::vector<int64_t> seq(sequence_size);
+
+    auto positions = make_positions(1 << 16);
+
+    for (auto _ : state)
+    {
+        for (int64_t pos : positions)
+            benchmark::DoNotOptimize(seq.at(pos));
+    }
+
+    state.SetItemsProcessed(state.iterations() * positions.size());
+}
+
+static void BM_DequeAt(benchmark::State& state)
+{
+    std::deque<int64_t> seq(sequence_size);
+
+    auto positions = make_positions(1 << 16);
+
+    for (auto _ : state)
+    {
+        for (int64_t pos : positions)
+            benchmark::DoNotOptimize(seq.at(pos));
+    }
+
+    state.SetItemsProcessed(state.iterations() * positions.size());
+}
+
+// reverse of a random range
+static void BM_SplayRopeReverse(benchmark::State& state)
+{
+    std::vector<int64_t> values(sequence_size);
+    splay_rope<int64_t> rope(values.begin(), values.end());
+
+    auto positions = make_positions(1 << 10);
+
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i + 1 < positions.size(); i += 2)
+            rope.reverse(std::min(positions[i], positions[i + 1]), std::max(positions[i], positions[i + 1]));
+    }
+
+    state.SetItemsProcessed(state.iterations() * positions.size() / 2);
+}
+
+static void BM_VectorReverse(benchmark::State& state)
+{
+    std::vector<int64_t> seq(sequence_size);
+
+    auto positions = make_positions(1 << 10);
+
+    for (auto _ : state)
+    {
+        for (size_t i = 0; i + 1 < positions.size(); i += 2)
+            std::reverse(seq.begin() + std::min(positions[i], positions[i + 1]), seq.begin() + std::max(positions[i], positions[i + 1]));
+    }
+
+    state.SetItemsProcessed(state.iterations() * positions.size() / 2);
+}
+
+BENCHMARK(BM_SplayRopeInsertErase)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_VectorInsertErase)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_DequeInsertErase)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SplayRopeAt)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_VectorAt)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_DequeAt)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SplayRopeReverse)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_VectorReverse)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,77 @@
+#include "splay_tree_dump.h"
+#include "bench_utils.h"
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+
+
+// Restoring a tree of n elements: load of a binary dump (memory-mapped file) against n inserts in random order
+// Args: n
+
+static const std::string dump_path = "bench_splay_tree.dump";
+
+static std::vector<int64_t> make_keys(size_t n)
+{
+    return make_uniform_trace(n, (size_t)1 << 40, 3);
+}
+
+static void BM_SplayTreeDump(benchmark::State& state)
+{
+    splay_tree<int64_t, int64_t> tree;
+    for (int64_t key : make_keys(state.range(0)))
+        tree.insert(std::make_pair(key, key));
+
+    for (auto _ : state)
+        splay_tree_dump<int64_t, int64_t>::dump(tree, dump_path);
+
+    state.SetBytesProcessed(state.iterations() * (sizeof(splay_tree_dump_header) + tree.size() * 2 * sizeof(int64_t)));
+    state.SetItemsProcessed(state.iterations() * tree.size());
+}
+
+static void BM_SplayTreeLoad(benchmark::State& state)
+{
+    {
+        splay_tree<int64_t, int64_t> tree;
+        for (int64_t key : make_keys(state.range(0)))
+            tree.insert(std::make_pair(key, key));
+
+        splay_tree_dump<int64_t, int64_t>::dump(tree, dump_path);
+    }
+
+    size_t n = 0;
+
+    for (auto _ : state)
+    {
+        auto tree = splay_tree_dump<int64_t, int64_t>::load(dump_path);
+        n = tree.size();
+    }
+
+    std::remove(dump_path.c_str());
+
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+static void BM_SplayTreeInsertAll(benchmark::State& state)
+{
+    std::vector<int64_t> keys = make_keys(state.range(0));
+
+    size_t n = 0;
+
+    for (auto _ : state)
+    {
+        splay_tree<int64_t, int64_t> tree;
+        for (int64_t key : keys)
+            tree.insert(std::make_pair(key, key));
+
+        n = tree.size();
+    }
+
+    state.SetItemsProcessed(state.iterations() * n);
+}
+
+BENCHMARK(BM_SplayTreeDump)->Arg(1 << 16)->Arg(1 << 20)->Arg(1 << 22)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SplayTreeLoad)->Arg(1 << 16)->Arg(1 << 20)->Arg(1 << 22)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SplayTreeInsertAll)->Arg(1 << 16)->Arg(1 << 20)->Arg(1 << 22)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,285 @@
+#include "splay_tree.h"
+#include "bench_utils.h"
+#include <benchmark/benchmark.h>
+
+#include <map>
+#include <unordered_map>
+#include <vector>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+
+
+// Insert, find, extract and mixed workloads on splay_tree, std::map and std::unordered_map
+// Args: distribution (see make_index_trace), n - number of elements
+//
+// A container holds keys 0, 2, ..., 2 * (n - 1), built in sorted order (balanced for both trees).
+// Every iteration runs a trace of 2^16 operations on indexes of the keys:
+//		* insert - inserts absent odd keys 2 * i + 1, they are erased untimed after the iteration
+//		* find - finds existing even keys 2 * i
+//		* extract - extracts even keys 2 * i (repeated indexes miss), they are inserted back untimed
+//		* mixed - 50% finds of even keys, 25% inserts and 25% erases of odd keys
+// After the timed iterations one more pass times every operation for latency percentiles,
+// which include the cost of two clock reads (about 20-50 ns)
+//
+// Sizes go from 1K up to the SPLAY_TREE_BENCH_MAX_SIZE environment variable (1M by default), e.g.
+//		SPLAY_TREE_BENCH_MAX_SIZE=50000000 ./bench_splay_tree --benchmark_filter=FindWorkload
+// runs sizes up to 50M, which need a few GB of memory per container
+
+typedef splay_tree<int64_t, int64_t> splay_map;
+typedef std::map<int64_t, int64_t> std_map;
+typedef std::unordered_map<int64_t, int64_t> hash_map;
+
+enum class workload { insert, find, extract, mixed };
+
+static const size_t trace_length = 1 << 16;
+
+// Returns trace of key indexes in [0, n):
+//		0 - uniform, 1, 2, 3 - Zipfian with skew 0.8, 0.99 and 1.2 (hot keys scattered over the key space),
+//		4 - sequential (cyclic), 5 - working set shift: 8 phases drawing uniformly from a window of n / 64 keys,
+//		the window moves by n / 8 every phase
+static std::vector<int64_t> make_index_trace(int distribution, size_t n)
+{
+    switch (distribution)
+    {
+    case 1:
+        return make_zipf_trace(trace_length, n, 0.8);
+    case 2:
+        return make_zipf_trace(trace_length, n, 0.99);
+    case 3:
+        return make_zipf_trace(trace_length, n, 1.2);
+    case 4:
+    {
+        std::vector<int64_t> trace(trace_length);
+        for (size_t i = 0; i < trace_length; ++i)
+            trace[i] = (int64_t)(i % n);
+
+        return trace;
+    }
+    case 5:
+    {
+        const size_t window = std::max(n / 64, (size_t)1);
+        const size_t phase_length = trace_length / 8;
+
+        std::vector<int64_t> trace = make_uniform_trace(trace_length, window);
+        for (size_t i = 0; i < trace_length; ++i)
+            trace[i] = (int64_t)((trace[i] + (i / phase_length) * (n / 8)) % n);
+
+        return trace;
+    }
+    default:
+        return make_uniform_trace(trace_length, n);
+    }
+}
+
+static void fill(splay_map& map, size_t n)
+{
+    std::vector<std::pair<int64_t, int64_t>> values(n);
+    for (size_t i = 0; i < n; ++i)
+        values[i] = std::make_pair(2 * (int64_t)i, 2 * (int64_t)i);
+
+    map = splay_map(values.begin(), values.end());
+}
+
+static void fill(std_map& map, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+        map.emplace_hint(map.end(), 2 * (int64_t)i, 2 * (int64_t)i);
+}
+
+static void fill(hash_map& map, size_t n)
+{
+    map.reserve(n);
+
+    for (size_t i = 0; i < n; ++i)
+        map.emplace(2 * (int64_t)i, 2 * (int64_t)i);
+}
+
+// Runs one operation of the workload on the i-th index of the trace
+template<class Map>
+static bool run_operation(Map& map, workload w, size_t i, int64_t index)
+{
+    const int64_t even = 2 * index;
+    const int64_t odd = 2 * index + 1;
+
+    switch (w)
+    {
+    case workload::insert:
+        return map.insert(std::make_pair(odd, odd)).second;
+    case workload::find:
+        return map.find(even) != map.end();
+    case workload::extract:
+        return !map.extract(even).empty();
+    default:
+        switch (i % 4)
+        {
+        case 0:
+            return map.insert(std::make_pair(odd, odd)).second;
+        case 1:
+            return map.erase(odd) != 0;
+        default:
+            return map.find(even) != map.end();
+        }
+    }
+}
+
+// Runs the trace, with Timed also writes latency of every operation in nanoseconds
+template<bool Timed, class Map>
+static void run_pass(Map& map, workload w, const std::vector<int64_t>& trace, uint64_t* latencies)
+{
+    for (size_t i = 0; i < trace.size(); ++i)
+    {
+        if (Timed)
+        {
+            auto start = std::chrono::steady_clock::now();
+            benchmark::DoNotOptimize(run_operation(map, w, i, trace[i]));
+            auto finish = std::chrono::steady_clock::now();
+
+            latencies[i] = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(finish - start).count();
+        }
+        else
+            benchmark::DoNotOptimize(run_operation(map, w, i, trace[i]));
+    }
+}
+
+// Brings the container back to keys 0, 2, ..., 2 * (n - 1) after a pass of insert or extract workload
+template<class Map>
+static void restore(Map& map, workload w, const std::vector<int64_t>& trace)
+{
+    for (int64_t index : trace)
+    {
+        if (w == workload::insert)
+            map.erase(2 * index + 1);
+        else if (w == workload::extract)
+            map.insert(std::make_pair(2 * index, 2 * index));
+    }
+}
+
+template<class Map>
+static void run_workload(benchmark::State& state, workload w)
+{
+    const size_t n = state.range(1);
+    const std::vector<int64_t> trace = make_index_trace((int)state.range(0), n);
+
+    Map map;
+    fill(map, n);
+
+    const bool restored = (w == workload::insert || w == workload::extract);
+
+    for (auto _ : state)
+    {
+        run_pass<false>(map, w, trace, nullptr);
+
+        if (restored)
+        {
+            state.PauseTiming();
+            restore(map, w, trace);
+            state.ResumeTiming();
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * trace.size());
+
+    std::vector<uint64_t> latencies(trace.size());
+    run_pass<true>(map, w, trace, latencies.data());
+
+    std::sort(latencies.begin(), latencies.end());
+
+    state.counters["p50_ns"] = (double)latencies[latencies.size() / 2];
+    state.counters["p90_ns"] = (double)latencies[latencies.size() * 9 / 10];
+    state.counters["p99_ns"] = (double)latencies[latencies.size() * 99 / 100];
+    state.counters["p999_ns"] = (double)latencies[latencies.size() * 999 / 1000];
+}
+
+// Every distribution with sizes from 1K up to SPLAY_TREE_BENCH_MAX_SIZE
+static void workload_args(benchmark::internal::Benchmark* b)
+{
+    size_t max_size = 1000000;
+
+    if (const char* env = std::getenv("SPLAY_TREE_BENCH_MAX_SIZE"))
+        max_size = (size_t)std::strtoull(env, nullptr, 10);
+
+    const int64_t sizes[] = { 1000, 32000, 1000000, 16000000, 50000000 };
+
+    b->ArgNames({ "distribution", "n" });
+
+    for (int distribution = 0; distribution < 6; ++distribution)
+        for (int64_t n : sizes)
+            if ((size_t)n <= max_size)
+                b->Args({ distribution, n });
+}
+
+static void BM_SplayTreeInsertWorkload(benchmark::State& state)
+{
+    run_workload<splay_map>(state, workload::insert);
+}
+
+static void BM_StdMapInsertWorkload(benchmark::State& state)
+{
+    run_workload<std_map>(state, workload::insert);
+}
+
+static void BM_UnorderedMapInsertWorkload(benchmark::State& state)
+{
+    run_workload<hash_map>(state, workload::insert);
+}
+
+static void BM_SplayTreeFindWorkload(benchmark::State& state)
+{
+    run_workload<splay_map>(state, workload::find);
+}
+
+static void BM_StdMapFindWorkload(benchmark::State& state)
+{
+    run_workload<std_map>(state, workload::find);
+}
+
+static void BM_UnorderedMapFindWorkload(benchmark::State& state)
+{
+    run_workload<hash_map>(state, workload::find);
+}
+
+static void BM_SplayTreeExtractWorkload(benchmark::State& state)
+{
+    run_workload<splay_map>(state, workload::extract);
+}
+
+static void BM_StdMapExtractWorkload(benchmark::State& state)
+{
+    run_workload<std_map>(state, workload::extract);
+}
+
+static void BM_UnorderedMapExtractWorkload(benchmark::State& state)
+{
+    run_workload<hash_map>(state, workload::extract);
+}
+
+static void BM_SplayTreeMixedWorkload(benchmark::State& state)
+{
+    run_workload<splay_map>(state, workload::mixed);
+}
+
+static void BM_StdMapMixedWorkload(benchmark::State& state)
+{
+    run_workload<std_map>(state, workload::mixed);
+}
+
+static void BM_UnorderedMapMixedWorkload(benchmark::State& state)
+{
+    run_workload<hash_map>(state, workload::mixed);
+}
+
+BENCHMARK(BM_SplayTreeInsertWorkload)->Apply(workload_args)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_StdMapInsertWorkload)->Apply(workload_args)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_UnorderedMapInsertWorkload)->Apply(workload_args)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SplayTreeFindWorkload)->Apply(workload_args)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_StdMapFindWorkload)->Apply(workload_args)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_UnorderedMapFindWorkload)->Apply(workload_args)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SplayTreeExtractWorkload)->Apply(workload_args)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_StdMapExtractWorkload)->Apply(workload_args)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_UnorderedMapExtractWorkload)->Apply(workload_args)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_SplayTreeMixedWorkload)->Apply(workload_args)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_StdMapMixedWorkload)->Apply(workload_args)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_UnorderedMapMixedWorkload)->Apply(workload_args)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,75 @@
+//
+// "bench_utils.h" contains key generators shared by splay tree's benchmarks
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include <vector>
+#include <random>
+#include <algorithm>
+
+
+// Zipfian distribution over [0, n): key k is drawn with probability proportional to 1 / (k + 1)^s
+// Keys are scattered with a fixed permutation, so hot keys are not neighbours in key order
+class zipf_generator
+{
+public:
+    zipf_generator(size_t n, double s, uint64_t seed = 42) : rng(seed), cdf(n), keys(n)
+    {
+        double sum = 0;
+        for (size_t i = 0; i < n; ++i)
+        {
+            sum += 1.0 / std::pow((double)(i + 1), s);
+            cdf[i] = sum;
+        }
+        for (size_t i = 0; i < n; ++i)
+        {
+            cdf[i] /= sum;
+            keys[i] = (int64_t)i;
+        }
+
+        std::shuffle(keys.begin(), keys.end(), rng);
+    }
+
+    int64_t operator() ()
+    {
+        double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+        size_t i = std::lower_bound(cdf.begin(), cdf.end(), u) - cdf.begin();
+
+        return keys[std::min(i, keys.size() - 1)];
+    }
+
+private:
+    std::mt19937_64 rng;
+
+    std::vector<double> cdf;
+    std::vector<int64_t> keys;
+};
+
+// Returns trace of n keys drawn from the Zipfian distribution over [0, key_space)
+inline std::vector<int64_t> make_zipf_trace(size_t n, size_t key_space, double s, uint64_t seed = 42)
+{
+    zipf_generator gen(key_space, s, seed);
+
+    std::vector<int64_t> trace(n);
+    for (auto& k : trace)
+        k = gen();
+
+    return trace;
+}
+
+// Returns trace of n keys drawn uniformly from [0, key_space)
+inline std::vector<int64_t> make_uniform_trace(size_t n, size_t key_space, uint64_t seed = 42)
+{
+    std::mt19937_64 rng(seed);
+    std::uniform_int_distribution<int64_t> dist(0, (int64_t)key_space - 1);
+
+    std::vector<int64_t> trace(n);
+    for (auto& k : trace)
+        k = dist(rng);
+
+    return trace;
+}
@@ -0,0 +1,635 @@
+//
+// "compact_splay_tree.h" is a library with splay tree stored in contiguous arrays with 32-bit links
+//
+
+#pragma once
+
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+
+#include "splay_compare.h"
+
+
+// Order of nodes in memory after compact_splay_tree::relayout()
+enum class layout_order
+{
+    in_order,       // nodes sorted by key: scans and neighbour accesses touch consecutive memory
+    van_emde_boas   // recursive split of the tree by height: every root-to-leaf path touches O(log_B(n)) blocks
+};
+
+
+// Compact splay tree structure
+//
+// Nodes live in one contiguous array and are linked by 32-bit indices instead of pointers
+// (16 bytes of links and size per node), keys and values are kept in parallel arrays.
+// Erase moves the last node into the freed slot, so the arrays are always dense.
+//
+// After long random updates neighbouring nodes are scattered over the arrays,
+// relayout() renumbers nodes in in-order or van Emde Boas order without changing the tree shape.
+//
+// Iterators are invalidated by insert, erase and relayout
+//
+// type Key requirements:
+//		* copy constructor, move assignment
+// 		* overloaded < or > (less or greater operator) or specify comparation rule as Compare type
+//
+// type T requirements:
+//		* copy constructor, move assignment
+//
+
+template<class Key, class T, class Compare = std::less<>>
+class compact_splay_tree
+{
+public:
+    typedef std::pair<const Key, T> value_type;
+private:
+    typedef uint32_t index_type;
+    static constexpr index_type npos = UINT32_MAX; // no node
+
+    struct node_type
+    {
+        index_type parent;
+        index_type l_child;
+        index_type r_child;
+
+        index_type size; // number of nodes in the subtree
+    };
+public:
+    class iterator
+    {
+        friend class compact_splay_tree;
+    public:
+        iterator() : iterator(nullptr, npos) {}
+
+        std::pair<const Key&, T&> operator* () const { return { tree->keys[i], tree->values[i] }; }
+        iterator& operator++ () { i = tree->next_node(i); return *this; }
+
+        friend bool operator== (const iterator& it1, const iterator& it2) { return it1.i == it2.i && it1.tree == it2.tree; }
+        friend bool operator!= (const iterator& it1, const iterator& it2) { return !(it1 == it2); }
+
+    private:
+        iterator(compact_splay_tree* tree, index_type i) : tree(tree), i(i) {}
+
+        compact_splay_tree* tree;
+        index_type i;
+    };
+
+    compact_splay_tree(Compare comp = Compare{});
+
+    std::pair<iterator, bool> insert(const value_type& value);
+    size_t erase(const Key& key);
+    iterator find(const Key& key);
+    iterator lower_bound(const Key& key);
+
+    void relayout(layout_order order = layout_order::van_emde_boas);
+    void reserve(size_t n);
+
+    bool empty() const;
+    size_t size() const;
+    iterator begin();
+    iterator end();
+private:
+    index_type descend(const Key& key, int& c) const;
+    void remove_node(index_type v);
+
+    void splay(index_type n);
+    void splay_max();
+    void zig_l(index_type n);
+    void zig_r(index_type n);
+    void replace_child(index_type parent, index_type old_child, index_type new_child);
+
+    void veb_order(index_type v, size_t levels, std::vector<index_type>& order) const;
+    size_t height() const;
+
+    index_type next_node(index_type n) const;
+    index_type subtree_size(index_type n) const;
+    void update_size(index_type n);
+
+
+    std::vector<node_type> nodes;
+    std::vector<Key> keys;  // keys[i] is the key of nodes[i]
+    std::vector<T> values;  // values[i] is the value of nodes[i]
+
+    index_type root;
+
+    Compare comp;
+};
+
+
+
+// public:
+template<class Key, class T, class Compare>
+compact_splay_tree<Key, T, Compare>::compact_splay_tree(Compare comp)
+{
+    root = npos;
+    this->comp = comp;
+}
+
+// Inserts value
+// Returns iterator of the element with the key and whether insertion is successidied
+// Throws std::length_error if the tree already has the maximum number of nodes
+// O(log(n)) amortized
+template<class Key, class T, class Compare>
+std::pair<typename compact_splay_tree<Key, T, Compare>::iterator, bool> compact_splay_tree<Key, T, Compare>::insert(const value_type& value)
+{
+    int c;
+    index_type search = descend(value.first, c);
+
+    if (search != npos && c == 0)
+    {
+        splay(search);
+
+        return { iterator(this, search), false };
+    }
+
+    if (nodes.size() >= (size_t)npos)
+        throw std::length_error("compact_splay_tree can't hold more than 2^32 - 1 nodes");
+
+    index_type v = (index_type)nodes.size();
+
+    nodes.push_back(node_type{ search, npos, npos, 1 });
+    keys.push_back(value.first);
+    values.push_back(value.second);
+
+    if (search == npos)
+        root = v;
+    else
+    {
+        if (c < 0)
+            nodes[search].l_child = v;
+        else
+            nodes[search].r_child = v;
+
+        for (index_type p = search; p != npos; p = nodes[p].parent)
+            ++nodes[p].size;
+    }
+
+    splay(v);
+
+    return { iterator(this, v), true };
+}
+
+// Erases node with the key
+// O(log(n)) amortized
+template<class Key, class T, class Compare>
+size_t compact_splay_tree<Key, T, Compare>::erase(const Key& key)
+{
+    int c;
+    index_type search = descend(key, c);
+
+    if (search == npos)
+        return (size_t)0;
+
+    splay(search);
+
+    if (c != 0)
+        return (size_t)0;
+
+    // the key exists and it is in the root now
+    index_type l_root = nodes[search].l_child;
+    index_type r_root = nodes[search].r_child;
+
+    if (l_root == npos)
+    {
+        root = r_root;
+        if (root != npos)
+            nodes[root].parent = npos;
+    }
+    else
+    {
+        root = l_root; // left tree - main tree
+        nodes[root].parent = npos;
+
+        if (r_root != npos)
+        {
+            splay_max();
+
+            nodes[root].r_child = r_root;
+            nodes[r_root].parent = root;
+            update_size(root);
+        }
+    }
+
+    remove_node(search);
+
+    return (size_t)1;
+}
+
+// Returns iterator of node with the key
+// O(log(n)) amortized
+template<class Key, class T, class Compare>
+typename compact_splay_tree<Key, T, Compare>::iterator compact_splay_tree<Key, T, Compare>::find(const Key& key)
+{
+    int c;
+    index_type search = descend(key, c);
+
+    if (search == npos)
+        return end();
+
+    splay(search);
+
+    return (c == 0) ? iterator(this, search) : end();
+}
+
+// Returns iterator of the first element with key not less than the key or end() if there is no such element
+// O(log(n)) amortized
+template<class Key, class T, class Compare>
+typename compact_splay_tree<Key, T, Compare>::iterator compact_splay_tree<Key, T, Compare>::lower_bound(const Key& key)
+{
+    index_type bound = npos, last = npos;
+
+    for (index_type v = root; v != npos;)
+    {
+        last = v;
+
+        if (comp(keys[v], key))
+            v = nodes[v].r_child;
+        else
+        {
+            bound = v;
+            v = nodes[v].l_child;
+        }
+    }
+
+    if (last != npos)
+        splay(bound != npos ? bound : last);
+
+    return iterator(this, bound);
+}
+
+// Renumbers nodes in the given order to restore memory locality, the tree shape is not changed
+// O(n) for in-order, O(n * log(h)) for van Emde Boas order of the tree with h levels
+template<class Key, class T, class Compare>
+void compact_splay_tree<Key, T, Compare>::relayout(layout_order order)
+{
+    std::vector<index_type> old_index; // old_index[i] is the node that gets number i
+    old_index.reserve(nodes.size());
+
+    if (order == layout_order::in_order)
+    {
+        index_type v = root;
+        while (v != npos && nodes[v].l_child != npos)
+            v = nodes[v].l_child;
+
+        for (; v != npos; v = next_node(v))
+            old_index.push_back(v);
+    }
+    else
+        veb_order(root, height(), old_index);
+
+    std::vector<index_type> new_index(nodes.size());
+    for (size_t i = 0; i < old_index.size(); ++i)
+        new_index[old_index[i]] = (index_type)i;
+
+    auto renumber = [&new_index](index_type v) { return (v != npos) ? new_index[v] : npos; };
+
+    std::vector<node_type> new_nodes;
+    std::vector<Key> new_keys;
+    std::vector<T> new_values;
+
+    new_nodes.reserve(nodes.size());
+    new_keys.reserve(nodes.size());
+    new_values.reserve(nodes.size());
+
+    for (index_type v : old_index)
+    {
+        new_nodes.push_back(node_type{ renumber(nodes[v].parent), renumber(nodes[v].l_child), renumber(nodes[v].r_child), nodes[v].size });
+        new_keys.push_back(std::move(keys[v]));
+        new_values.push_back(std::move(values[v]));
+    }
+
+    root = renumber(root);
+
+    nodes.swap(new_nodes);
+    keys.swap(new_keys);
+    values.swap(new_values);
+}
+
+// Reserves memory for n nodes
+// O(n)
+template<class Key, class T, class Compare>
+void compact_splay_tree<Key, T, Compare>::reserve(size_t n)
+{
+    nodes.reserve(n);
+    keys.reserve(n);
+    values.reserve(n);
+}
+
+// Returns weather splay tree is empty (true) or not (false)
+// O(1)
+template<class Key, class T, class Compare>
+bool compact_splay_tree<Key, T, Compare>::empty() const
+{
+    return (root == npos);
+}
+
+// Returns number of elements
+// O(1)
+template<class Key, class T, class Compare>
+size_t compact_splay_tree<Key, T, Compare>::size() const
+{
+    return nodes.size();
+}
+
+// Returns iterator to the element with the smallest key
+// O(log(n))
+template<class Key, class T, class Compare>
+typename compact_splay_tree<Key, T, Compare>::iterator compact_splay_tree<Key, T, Compare>::begin()
+{
+    index_type v = root;
+    while (v != npos && nodes[v].l_child != npos)
+        v = nodes[v].l_child;
+
+    return iterator(this, v);
+}
+
+// Returns iterator to the end of the splay tree
+// O(1)
+template<class Key, class T, class Compare>
+typename compact_splay_tree<Key, T, Compare>::iterator compact_splay_tree<Key, T, Compare>::end()
+{
+    return iterator(this, npos);
+}
+
+// private:
+
+// Returns node with the key or the last node on the search path (npos for empty tree)
+// c is the comparison of the key with the returned node's key
+// O(depth)
+template<class Key, class T, class Compare>
+typename compact_splay_tree<Key, T, Compare>::index_type compact_splay_tree<Key, T, Compare>::descend(const Key& key, int& c) const
+{
+    index_type v = root;
+    c = 0;
+
+    while (v != npos)
+    {
+        c = three_way_compare(comp, key, keys[v]);
+
+        index_type next = (c < 0) ? nodes[v].l_child : nodes[v].r_child;
+
+        if (c == 0 || next == npos)
+            return v;
+
+        v = next;
+    }
+
+    return v;
+}
+
+// Frees the slot of the unlinked node v by moving the last node into it
+// O(1)
+template<class Key, class T, class Compare>
+void compact_splay_tree<Key, T, Compare>::remove_node(index_type v)
+{
+    index_type last = (index_type)(nodes.size() - 1);
+
+    if (v != last)
+    {
+        nodes[v] = nodes[last];
+        keys[v] = std::move(keys[last]);
+        values[v] = std::move(values[last]);
+
+        replace_child(nodes[v].parent, last, v);
+        if (nodes[v].l_child != npos)
+            nodes[nodes[v].l_child].parent = v;
+        if (nodes[v].r_child != npos)
+            nodes[nodes[v].r_child].parent = v;
+    }
+
+    nodes.pop_back();
+    keys.pop_back();
+    values.pop_back();
+}
+
+// ascend the node to the root
+// O(log(n)) amortized
+template<class Key, class T, class Compare>
+void compact_splay_tree<Key, T, Compare>::splay(index_type n)
+{
+    while (n != root)
+    {
+        index_type p = nodes[n].parent;
+        index_type g = nodes[p].parent;
+
+        if (g == npos)
+        {
+            if (n == nodes[p].l_child)
+                zig_l(n);
+            else
+                zig_r(n);
+        }
+        else
+        {
+            if (p == nodes[g].l_child)
+            {
+                if (n == nodes[p].l_child)
+                {
+                    zig_l(p);
+                    zig_l(n);
+                }
+                else
+                {
+                    zig_r(n);
+                    zig_l(n);
+                }
+            }
+            else
+            {
+                if (n == nodes[p].r_child)
+                {
+                    zig_r(p);
+                    zig_r(n);
+                }
+                else
+                {
+                    zig_l(n);
+                    zig_r(n);
+                }
+            }
+        }
+    }
+}
+
+// ascend the node with the greatest key to the root
+// O(log(n)) amortized
+template<class Key, class T, class Compare>
+void compact_splay_tree<Key, T, Compare>::splay_max()
+{
+    if (root == npos)
+        return;
+
+    index_type max = root;
+    while (nodes[max].r_child != npos)
+        max = nodes[max].r_child;
+
+    splay(max);
+}
+
+// left turn of the node
+// O(1)
+template<class Key, class T, class Compare>
+void compact_splay_tree<Key, T, Compare>::zig_l(index_type n)
+{
+    // x = n
+    // y = nodes[n].parent
+
+    index_type y = nodes[n].parent;
+    index_type y_parent = nodes[y].parent;
+
+    replace_child(y_parent, y, n);
+
+    nodes[y].l_child = nodes[n].r_child; // y->l_child = x->r_child
+    if (nodes[n].r_child != npos)
+        nodes[nodes[n].r_child].parent = y;
+
+    nodes[y].parent = n;        // y->parent = x
+    nodes[n].r_child = y;       // x->r_child = y
+    nodes[n].parent = y_parent; // x->parent = y->parent
+
+    update_size(y);
+    update_size(n);
+}
+
+// right turn of the node
+// O(1)
+template<class Key, class T, class Compare>
+void compact_splay_tree<Key, T, Compare>::zig_r(index_type n)
+{
+    // x = n
+    // y = nodes[n].parent
+
+    index_type y = nodes[n].parent;
+    index_type y_parent = nodes[y].parent;
+
+    replace_child(y_parent, y, n);
+
+    nodes[y].r_child = nodes[n].l_child; // y->r_child = x->l_child
+    if (nodes[n].l_child != npos)
+        nodes[nodes[n].l_child].parent = y;
+
+    nodes[y].parent = n;        // y->parent = x
+    nodes[n].l_child = y;       // x->l_child = y
+    nodes[n].parent = y_parent; // x->parent = y->parent
+
+    update_size(y);
+    update_size(n);
+}
+
+// Makes new_child the child of the parent in place of old_child (or the root if there is no parent)
+// O(1)
+template<class Key, class T, class Compare>
+void compact_splay_tree<Key, T, Compare>::replace_child(index_type parent, index_type old_child, index_type new_child)
+{
+    if (parent == npos)
+        root = new_child;
+    else if (nodes[parent].l_child == old_child)
+        nodes[parent].l_child = new_child;
+    else
+        nodes[parent].r_child = new_child;
+}
+
+// Appends nodes of the top levels of subtree v in van Emde Boas order:
+// the top half of the levels first, then every subtree hanging below it, each laid out recursively
+// O(k * log(levels)) for k appended nodes
+template<class Key, class T, class Compare>
+void compact_splay_tree<Key, T, Compare>::veb_order(index_type v, size_t levels, std::vector<index_type>& order) const
+{
+    if (v == npos || levels == 0)
+        return;
+
+    if (levels == 1)
+    {
+        order.push_back(v);
+        return;
+    }
+
+    size_t top = levels / 2;
+
+    veb_order(v, top, order);
+
+    // roots of the bottom subtrees: nodes at depth top below v, from left to right
+    std::vector<index_type> frontier(1, v);
+    for (size_t d = 0; d < top && !frontier.empty(); ++d)
+    {
+        std::vector<index_type> next;
+        for (index_type x : frontier)
+        {
+            if (nodes[x].l_child != npos)
+                next.push_back(nodes[x].l_child);
+            if (nodes[x].r_child != npos)
+                next.push_back(nodes[x].r_child);
+        }
+        frontier.swap(next);
+    }
+
+    for (index_type x : frontier)
+        veb_order(x, levels - top, order);
+}
+
+// Returns number of levels of the tree
+// O(n)
+template<class Key, class T, class Compare>
+size_t compact_splay_tree<Key, T, Compare>::height() const
+{
+    size_t h = 0;
+
+    std::vector<std::pair<index_type, size_t>> q; // node and its level
+    if (root != npos)
+        q.push_back({ root, 1 });
+
+    while (!q.empty())
+    {
+        auto x = q.back(); q.pop_back();
+
+        h = std::max(h, x.second);
+
+        if (nodes[x.first].l_child != npos)
+            q.push_back({ nodes[x.first].l_child, x.second + 1 });
+        if (nodes[x.first].r_child != npos)
+            q.push_back({ nodes[x.first].r_child, x.second + 1 });
+    }
+
+    return h;
+}
+
+// Returns the next node in key order, npos for the last one
+// O(1) amortized
+template<class Key, class T, class Compare>
+typename compact_splay_tree<Key, T, Compare>::index_type compact_splay_tree<Key, T, Compare>::next_node(index_type n) const
+{
+    if (nodes[n].r_child != npos)
+    {
+        n = nodes[n].r_child;
+        while (nodes[n].l_child != npos)
+            n = nodes[n].l_child;
+
+        return n;
+    }
+
+    while (nodes[n].parent != npos && n == nodes[nodes[n].parent].r_child)
+        n = nodes[n].parent;
+
+    return nodes[n].parent;
+}
+
+// Returns number of nodes in the subtree (0 for npos)
+// O(1)
+template<class Key, class T, class Compare>
+typename compact_splay_tree<Key, T, Compare>::index_type compact_splay_tree<Key, T, Compare>::subtree_size(index_type n) const
+{
+    return (n != npos) ? nodes[n].size : 0;
+}
+
+// Recalculates size of the node from its children
+// O(1)
+template<class Key, class T, class Compare>
+void compact_splay_tree<Key, T, Compare>::update_size(index_type n)
+{
+    nodes[n].size = 1 + subtree_size(nodes[n].l_child) + subtree_size(nodes[n].r_child);
+}
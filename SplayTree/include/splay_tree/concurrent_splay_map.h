@@ -0,0 +1,320 @@
+//
+// "concurrent_splay_map.h" is a library with concurrent ordered map made of range-partitioned splay tree shards
+//
+
+#pragma once
+
+#include "splay_tree.h"
+
+#include <cstddef>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+
+
+// Concurrent splay map structure
+//
+// The key space is partitioned into ranges, every range is a shard: a splay tree with its own mutex.
+// insert, find and erase lock only the shard owning the key, so writers of different ranges run in parallel.
+// The directory of shard bounds is guarded by a shared mutex: operations hold it shared,
+// rebalance() holds it exclusively while it splits hot shards and merges cold ones.
+//
+// Since even find splays, a shard is locked exclusively by every operation
+//
+// type Key requirements:
+//		* copy constructor
+// 		* overloaded < or > (less or greater operator) or specify comparation rule as Compare type
+//
+// type T requirements:
+//		* copy constructor
+//
+
+template<class Key, class T, class Compare = std::less<>, class SplayPolicy = full_splay_policy>
+class concurrent_splay_map
+{
+public:
+    typedef std::pair<const Key, T> value_type;
+private:
+    struct shard
+    {
+        shard(Compare comp) : tree(comp), operations(0) {}
+
+        std::mutex mutex;
+
+        splay_tree<Key, T, Compare, SplayPolicy> tree;
+
+        size_t operations; // since the last rebalance, guarded by mutex
+    };
+public:
+    concurrent_splay_map(Compare comp = Compare{});
+    concurrent_splay_map(const std::vector<Key>& split_keys, Compare comp = Compare{});
+    concurrent_splay_map(const concurrent_splay_map&) = delete;
+
+    concurrent_splay_map& operator= (const concurrent_splay_map&) = delete;
+
+    bool insert(const value_type& value);
+    bool insert_or_assign(const Key& key, const T& obj);
+    size_t erase(const Key& key);
+    bool find(const Key& key, T& value);
+    bool contains(const Key& key);
+
+    template<class F>
+    void for_each_range(const Key& lo, const Key& hi, F f);
+
+    size_t rebalance(double hot_factor = 2.0);
+
+    bool empty() const;
+    size_t size() const;
+    size_t shard_count() const;
+private:
+    size_t shard_index(const Key& key) const;
+
+    template<class F>
+    auto with_shard(const Key& key, F f);
+
+
+    std::vector<std::unique_ptr<shard>> shards;
+    std::vector<Key> bounds; // bounds[i] is the smallest key of shards[i + 1]
+
+    mutable std::shared_mutex directory_mutex;
+
+    Compare comp;
+};
+
+
+
+// public:
+template<class Key, class T, class Compare, class SplayPolicy>
+concurrent_splay_map<Key, T, Compare, SplayPolicy>::concurrent_splay_map(Compare comp) : concurrent_splay_map(std::vector<Key>(), comp)
+{
+}
+
+// Creates shards for ranges between the split keys
+// Unsorted split keys cause std::invalid_argument
+template<class Key, class T, class Compare, class SplayPolicy>
+concurrent_splay_map<Key, T, Compare, SplayPolicy>::concurrent_splay_map(const std::vector<Key>& split_keys, Compare comp)
+{
+    this->comp = comp;
+
+    for (size_t i = 1; i < split_keys.size(); ++i)
+        if (!comp(split_keys[i - 1], split_keys[i]))
+            throw std::invalid_argument("split keys are not sorted");
+
+    bounds = split_keys;
+
+    for (size_t i = 0; i <= bounds.size(); ++i)
+        shards.push_back(std::make_unique<shard>(comp));
+}
+
+// Inserts value
+// Returns true if insertion is successidied and false if the key already exists
+// O(log(n / shards)) amortized, locks one shard
+template<class Key, class T, class Compare, class SplayPolicy>
+bool concurrent_splay_map<Key, T, Compare, SplayPolicy>::insert(const value_type& value)
+{
+    return with_shard(value.first, [&value](shard& s) { return s.tree.insert(value).second; });
+}
+
+// Inserts element or assigns obj to the mapped value if the key exists
+// Returns true if the element was inserted
+// O(log(n / shards)) amortized, locks one shard
+template<class Key, class T, class Compare, class SplayPolicy>
+bool concurrent_splay_map<Key, T, Compare, SplayPolicy>::insert_or_assign(const Key& key, const T& obj)
+{
+    return with_shard(key, [&key, &obj](shard& s) { return s.tree.insert_or_assign(key, obj).second; });
+}
+
+// Erases element with the key
+// O(log(n / shards)) amortized, locks one shard
+template<class Key, class T, class Compare, class SplayPolicy>
+size_t concurrent_splay_map<Key, T, Compare, SplayPolicy>::erase(const Key& key)
+{
+    return with_shard(key, [&key](shard& s) { return s.tree.erase(key); });
+}
+
+// Copies the value of element with the key into value
+// Returns weather the key exists (true) or not (false)
+// O(log(n / shards)) amortized, locks one shard
+template<class Key, class T, class Compare, class SplayPolicy>
+bool concurrent_splay_map<Key, T, Compare, SplayPolicy>::find(const Key& key, T& value)
+{
+    return with_shard(key, [&key, &value](shard& s)
+    {
+        auto it = s.tree.find(key);
+
+        if (it == s.tree.end())
+            return false;
+
+        value = it->second;
+
+        return true;
+    });
+}
+
+// Returns weather the key exists (true) or not (false)
+// O(log(n / shards)) amortized, locks one shard
+template<class Key, class T, class Compare, class SplayPolicy>
+bool concurrent_splay_map<Key, T, Compare, SplayPolicy>::contains(const Key& key)
+{
+    return with_shard(key, [&key](shard& s) { return s.tree.find(key) != s.tree.end(); });
+}
+
+// Calls f(const value_type&) for every element with key in [lo, hi) in key order
+// Shards are locked one at a time: the scan of every shard is consistent, but the whole scan is not atomic
+// f must not call the map
+// O(log(n / shards) + k) amortized for k visited elements
+template<class Key, class T, class Compare, class SplayPolicy>
+template<class F>
+void concurrent_splay_map<Key, T, Compare, SplayPolicy>::for_each_range(const Key& lo, const Key& hi, F f)
+{
+    if (!comp(lo, hi))
+        return;
+
+    std::shared_lock<std::shared_mutex> directory_lock(directory_mutex);
+
+    for (size_t i = shard_index(lo); i < shards.size(); ++i)
+    {
+        if (i > 0 && !comp(bounds[i - 1], hi))
+            break;
+
+        shard& s = *shards[i];
+        std::lock_guard<std::mutex> lock(s.mutex);
+
+        ++s.operations;
+
+        for (auto it = s.tree.lower_bound(lo); it != s.tree.end() && comp(it->first, hi); ++it)
+            f(static_cast<const value_type&>(*it));
+    }
+}
+
+// Splits every shard that received more than hot_factor times the average number of operations
+// since the last rebalance at its median key, then merges neighbouring shards that together
+// received less than the average and resets operation counters
+// Blocks all operations while it runs
+// Returns the number of shards after rebalancing
+// O(shards * log(n)) amortized, medians of hot shards are selected by rank
+template<class Key, class T, class Compare, class SplayPolicy>
+size_t concurrent_splay_map<Key, T, Compare, SplayPolicy>::rebalance(double hot_factor)
+{
+    std::unique_lock<std::shared_mutex> directory_lock(directory_mutex);
+
+    size_t total = 0;
+    for (auto& s : shards)
+        total += s->operations;
+
+    const double average = (double)total / (double)shards.size();
+
+    std::vector<std::unique_ptr<shard>> new_shards;
+    std::vector<Key> new_bounds;
+    bool last_split = false; // halves of a split shard are not merged back
+
+    for (size_t i = 0; i < shards.size(); ++i)
+    {
+        shard& s = *shards[i];
+
+        if (i > 0)
+            new_bounds.push_back(bounds[i - 1]);
+
+        // hot shard: split at the median key
+        if ((double)s.operations > hot_factor * average && s.tree.size() >= 2)
+        {
+            Key median_key = s.tree.nth(s.tree.size() / 2)->first;
+
+            auto right = std::make_unique<shard>(comp);
+            right->tree = s.tree.split(median_key);
+
+            new_shards.push_back(std::move(shards[i]));
+            new_bounds.push_back(median_key);
+            new_shards.push_back(std::move(right));
+
+            last_split = true;
+            continue;
+        }
+
+        // cold neighbours: merge into the previous shard
+        if (!new_shards.empty() && !last_split && (double)(new_shards.back()->operations + s.operations) < average)
+        {
+            new_shards.back()->tree.join(s.tree);
+            new_shards.back()->operations += s.operations;
+            new_bounds.pop_back();
+
+            continue;
+        }
+
+        new_shards.push_back(std::move(shards[i]));
+        last_split = false;
+    }
+
+    for (auto& s : new_shards)
+        s->operations = 0;
+
+    shards.swap(new_shards);
+    bounds.swap(new_bounds);
+
+    return shards.size();
+}
+
+// Returns weather map is empty (true) or not (false)
+// O(shards)
+template<class Key, class T, class Compare, class SplayPolicy>
+bool concurrent_splay_map<Key, T, Compare, SplayPolicy>::empty() const
+{
+    return size() == 0;
+}
+
+// Returns number of elements, shards are counted one at a time
+// O(shards)
+template<class Key, class T, class Compare, class SplayPolicy>
+size_t concurrent_splay_map<Key, T, Compare, SplayPolicy>::size() const
+{
+    std::shared_lock<std::shared_mutex> directory_lock(directory_mutex);
+
+    size_t n = 0;
+    for (auto& s : shards)
+    {
+        std::lock_guard<std::mutex> lock(s->mutex);
+        n += s->tree.size();
+    }
+
+    return n;
+}
+
+// Returns number of shards
+// O(1)
+template<class Key, class T, class Compare, class SplayPolicy>
+size_t concurrent_splay_map<Key, T, Compare, SplayPolicy>::shard_count() const
+{
+    std::shared_lock<std::shared_mutex> directory_lock(directory_mutex);
+
+    return shards.size();
+}
+
+// private:
+
+// Returns index of the shard owning the key, the directory must be locked
+// O(log(shards))
+template<class Key, class T, class Compare, class SplayPolicy>
+size_t concurrent_splay_map<Key, T, Compare, SplayPolicy>::shard_index(const Key& key) const
+{
+    return std::upper_bound(bounds.begin(), bounds.end(), key, comp) - bounds.begin();
+}
+
+// Calls f(shard&) for the shard owning the key under its lock and counts the operation
+// O(log(shards)) + O(f)
+template<class Key, class T, class Compare, class SplayPolicy>
+template<class F>
+auto concurrent_splay_map<Key, T, Compare, SplayPolicy>::with_shard(const Key& key, F f)
+{
+    std::shared_lock<std::shared_mutex> directory_lock(directory_mutex);
+
+    shard& s = *shards[shard_index(key)];
+    std::lock_guard<std::mutex> lock(s.mutex);
+
+    ++s.operations;
+
+    return f(s);
+}
@@ -0,0 +1,270 @@
+//
+// "frozen_splay_tree.h" is a library with read-only snapshot of splay tree in cache-friendly layout
+//
+
+#pragma once
+
+#include "splay_tree.h"
+
+#include <cstddef>
+#include <vector>
+#include <utility>
+#include <functional>
+
+
+// Frozen splay tree structure
+//
+// Immutable copy of splay tree's elements made by frozen_splay_tree(const splay_tree&).
+// Keys are stored in Eytzinger (BFS) order of the implicit complete binary search tree, so
+// the first levels of every search share a few cache lines and the next levels are prefetched.
+// Lookups are branchless and never modify the structure.
+//
+// thaw() builds a new mutable splay tree from the snapshot in O(n)
+//
+
+template<class Key, class T, class Compare = std::less<>>
+class frozen_splay_tree
+{
+public:
+    class iterator
+    {
+        friend class frozen_splay_tree;
+    public:
+        iterator() : iterator(nullptr, 0) {}
+
+        std::pair<const Key&, const T&> operator* () const { return { tree->keys[k - 1], tree->values[k - 1] }; }
+        iterator& operator++ ();
+
+        friend bool operator== (const iterator& it1, const iterator& it2) { return it1.k == it2.k && it1.tree == it2.tree; }
+        friend bool operator!= (const iterator& it1, const iterator& it2) { return !(it1 == it2); }
+
+    private:
+        iterator(const frozen_splay_tree* tree, size_t k) : tree(tree), k(k) {}
+
+        const frozen_splay_tree* tree;
+        size_t k; // 1-based Eytzinger index, 0 for the end
+    };
+
+    frozen_splay_tree(Compare comp = Compare{});
+    template<class SplayPolicy>
+    explicit frozen_splay_tree(const splay_tree<Key, T, Compare, SplayPolicy>& tree);
+
+    iterator find(const Key& key) const;
+    iterator lower_bound(const Key& key) const;
+    bool contains(const Key& key) const;
+
+    template<class SplayPolicy = full_splay_policy>
+    splay_tree<Key, T, Compare, SplayPolicy> thaw() const;
+
+    bool empty() const;
+    size_t size() const;
+    iterator begin() const;
+    iterator end() const;
+private:
+    template<class It>
+    void build(It sorted, size_t n);
+    static void fill(size_t& i, size_t k, std::vector<size_t>& order);
+
+    size_t search(const Key& key) const;
+
+
+    std::vector<Key> keys;  // keys[k - 1] is the key of the k-th node in Eytzinger order
+    std::vector<T> values;  // values[k - 1] is the value of the k-th node in Eytzinger order
+
+    Compare comp;
+};
+
+template<class Key, class T, class Compare, class SplayPolicy>
+frozen_splay_tree(const splay_tree<Key, T, Compare, SplayPolicy>&) -> frozen_splay_tree<Key, T, Compare>;
+
+
+
+// Moves to the next element in key order
+// O(1) amortized
+template<class Key, class T, class Compare>
+typename frozen_splay_tree<Key, T, Compare>::iterator& frozen_splay_tree<Key, T, Compare>::iterator::operator++()
+{
+    size_t n = tree->keys.size();
+
+    if (2 * k + 1 <= n)
+    {
+        k = 2 * k + 1; // leftmost node of the right subtree
+        while (2 * k <= n)
+            k = 2 * k;
+    }
+    else
+    {
+        while (k & 1) // climb while k is a right child
+            k >>= 1;
+        k >>= 1;
+    }
+
+    return *this;
+}
+
+// public:
+template<class Key, class T, class Compare>
+frozen_splay_tree<Key, T, Compare>::frozen_splay_tree(Compare comp)
+{
+    this->comp = comp;
+}
+
+// Makes read-only snapshot of the tree in Eytzinger layout
+// Doesn't modify the tree
+// O(n)
+template<class Key, class T, class Compare>
+template<class SplayPolicy>
+frozen_splay_tree<Key, T, Compare>::frozen_splay_tree(const splay_tree<Key, T, Compare, SplayPolicy>& tree)
+{
+    comp = tree.comp;
+
+    std::vector<const std::pair<const Key, T>*> sorted;
+    sorted.reserve(tree.size());
+
+    for (auto* v : tree.flatten())
+        sorted.push_back(v->value);
+
+    build(sorted.begin(), sorted.size());
+}
+
+// Returns iterator of element with the key or end() if there is no such key
+// O(log(n)), branchless
+template<class Key, class T, class Compare>
+typename frozen_splay_tree<Key, T, Compare>::iterator frozen_splay_tree<Key, T, Compare>::find(const Key& key) const
+{
+    size_t k = search(key);
+
+    if (k != 0 && comp(key, keys[k - 1]))
+        k = 0;
+
+    return iterator(this, k);
+}
+
+// Returns iterator of the first element with key not less than the key or end() if there is no such element
+// O(log(n)), branchless
+template<class Key, class T, class Compare>
+typename frozen_splay_tree<Key, T, Compare>::iterator frozen_splay_tree<Key, T, Compare>::lower_bound(const Key& key) const
+{
+    return iterator(this, search(key));
+}
+
+// Returns weather the key exists (true) or not (false)
+// O(log(n)), branchless
+template<class Key, class T, class Compare>
+bool frozen_splay_tree<Key, T, Compare>::contains(const Key& key) const
+{
+    return find(key) != end();
+}
+
+// Returns mutable splay tree with the same elements
+// O(n)
+template<class Key, class T, class Compare>
+template<class SplayPolicy>
+splay_tree<Key, T, Compare, SplayPolicy> frozen_splay_tree<Key, T, Compare>::thaw() const
+{
+    return splay_tree<Key, T, Compare, SplayPolicy>(begin(), end(), comp);
+}
+
+// Returns weather frozen tree is empty (true) or not (false)
+// O(1)
+template<class Key, class T, class Compare>
+bool frozen_splay_tree<Key, T, Compare>::empty() const
+{
+    return keys.empty();
+}
+
+// Returns number of elements
+// O(1)
+template<class Key, class T, class Compare>
+size_t frozen_splay_tree<Key, T, Compare>::size() const
+{
+    return keys.size();
+}
+
+// Returns iterator to the element with the smallest key
+// O(log(n))
+template<class Key, class T, class Compare>
+typename frozen_splay_tree<Key, T, Compare>::iterator frozen_splay_tree<Key, T, Compare>::begin() const
+{
+    size_t k = keys.empty() ? 0 : 1;
+
+    while (k != 0 && 2 * k <= keys.size())
+        k = 2 * k;
+
+    return iterator(this, k);
+}
+
+// Returns iterator to the end of the frozen tree
+// O(1)
+template<class Key, class T, class Compare>
+typename frozen_splay_tree<Key, T, Compare>::iterator frozen_splay_tree<Key, T, Compare>::end() const
+{
+    return iterator(this, 0);
+}
+
+// private:
+
+// Copies n elements given in key order into Eytzinger layout
+// O(n)
+template<class Key, class T, class Compare>
+template<class It>
+void frozen_splay_tree<Key, T, Compare>::build(It sorted, size_t n)
+{
+    std::vector<size_t> order(n + 1); // order[k] is the in-order index of the k-th node
+
+    size_t i = 0;
+    fill(i, 1, order);
+
+    keys.reserve(n);
+    values.reserve(n);
+
+    for (size_t k = 1; k <= n; ++k)
+    {
+        keys.push_back(sorted[order[k]]->first);
+        values.push_back(sorted[order[k]]->second);
+    }
+}
+
+// Assigns in-order indexes to the nodes of the subtree k
+// O(n)
+template<class Key, class T, class Compare>
+void frozen_splay_tree<Key, T, Compare>::fill(size_t& i, size_t k, std::vector<size_t>& order)
+{
+    if (k >= order.size())
+        return;
+
+    fill(i, 2 * k, order);
+    order[k] = i++;
+    fill(i, 2 * k + 1, order);
+}
+
+// Returns Eytzinger index of the first key not less than the key, 0 if there is no such key
+// O(log(n)), branchless
+template<class Key, class T, class Compare>
+size_t frozen_splay_tree<Key, T, Compare>::search(const Key& key) const
+{
+    const size_t n = keys.size();
+    const Key* base = keys.data();
+
+    size_t k = 1;
+    while (k <= n)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        // descendants 4 levels below are 16 consecutive keys starting at 16 * k
+        __builtin_prefetch(base + ((16 * k <= n) ? 16 * k - 1 : 0));
+#endif
+        k = 2 * k + (size_t)comp(base[k - 1], key);
+    }
+
+    // after the answer node the search went only right: drop these trailing ones and the zero before them
+#if defined(__GNUC__) || defined(__clang__)
+    k >>= __builtin_ctzll(~(unsigned long long)k) + 1;
+#else
+    while (k & 1)
+        k >>= 1;
+    k >>= 1;
+#endif
+
+    return k;
+}
+
@@ -0,0 +1,317 @@
+//
+// "hashed_splay_map.h" is a library with ordered map built on splay tree with hash index for point lookups
+//
+
+#pragma once
+
+#include "splay_tree.h"
+
+#include <cstddef>
+#include <vector>
+#include <utility>
+#include <functional>
+
+
+// Hashed splay map structure
+//
+// Elements are kept in a splay tree for ordered operations (lower_bound, iteration, range erase)
+// and indexed by an open-addressing (linear probing) hash table from key to element.
+// Point lookups (find, contains) go through the hash table only: no descent and no rotations.
+// Insert and erase update both structures.
+//
+// The index holds the hash and the tree node of every element, which doesn't change while the element is in the tree,
+// so iterators of indexed elements are made without descent.
+// Load factor is kept at most 1/2, erase uses backward shift instead of tombstones
+//
+// type Key requirements:
+//		* copy constructor
+// 		* overloaded < or > (less or greater operator) or specify comparation rule as Compare type
+//		* Hash consistent with Compare: equivalent keys have equal hashes
+//
+
+template<class Key, class T, class Hash = std::hash<Key>, class Compare = std::less<>, class SplayPolicy = full_splay_policy>
+class hashed_splay_map
+{
+public:
+    typedef std::pair<const Key, T> value_type;
+    typedef typename splay_tree<Key, T, Compare, SplayPolicy>::iterator iterator;
+private:
+    typedef typename splay_tree<Key, T, Compare, SplayPolicy>::node_type node_type;
+
+    struct slot_type
+    {
+        size_t hash;
+        node_type* node; // nullptr for an empty slot
+    };
+public:
+    hashed_splay_map(Hash hash = Hash{}, Compare comp = Compare{});
+
+    std::pair<iterator, bool> insert(const value_type& value);
+    template<class M>
+    std::pair<iterator, bool> insert_or_assign(const Key& key, M&& obj);
+    size_t erase(const Key& key);
+    size_t erase_range(const Key& lo, const Key& hi);
+
+    value_type* find(const Key& key) const;
+    bool contains(const Key& key) const;
+    iterator lower_bound(const Key& key);
+
+    bool empty() const;
+    size_t size() const;
+    iterator begin() const;
+    iterator end() const;
+
+    size_t index_bytes() const;
+private:
+    size_t probe(const Key& key, size_t h) const;
+    void index(node_type* node, size_t h);
+    void unindex(size_t i);
+    void grow();
+
+    bool equal(const Key& a, const Key& b) const;
+
+
+    splay_tree<Key, T, Compare, SplayPolicy> tree;
+
+    std::vector<slot_type> slots; // size is 0 or a power of 2
+
+    Hash hasher;
+    Compare comp;
+};
+
+
+
+// public:
+template<class Key, class T, class Hash, class Compare, class SplayPolicy>
+hashed_splay_map<Key, T, Hash, Compare, SplayPolicy>::hashed_splay_map(Hash hash, Compare comp) : tree(comp)
+{
+    hasher = hash;
+    this->comp = comp;
+}
+
+// Inserts value
+// Returns iterator of the element with the key and whether insertion is successidied
+// O(1) expected if the key exists (doesn't splay), otherwise O(log(n)) amortized
+template<class Key, class T, class Hash, class Compare, class SplayPolicy>
+std::pair<typename hashed_splay_map<Key, T, Hash, Compare, SplayPolicy>::iterator, bool> hashed_splay_map<Key, T, Hash, Compare, SplayPolicy>::insert(const value_type& value)
+{
+    size_t h = hasher(value.first);
+    size_t i = probe(value.first, h);
+
+    if (i != slots.size())
+        return { iterator(slots[i].node, &tree), false };
+
+    auto result = tree.insert(value);
+    index(result.first.node, h);
+
+    return result;
+}
+
+// Inserts element or assigns obj to the mapped value if the key exists
+// O(1) expected if the key exists (doesn't splay), otherwise O(log(n)) amortized
+template<class Key, class T, class Hash, class Compare, class SplayPolicy>
+template<class M>
+std::pair<typename hashed_splay_map<Key, T, Hash, Compare, SplayPolicy>::iterator, bool> hashed_splay_map<Key, T, Hash, Compare, SplayPolicy>::insert_or_assign(const Key& key, M&& obj)
+{
+    size_t h = hasher(key);
+    size_t i = probe(key, h);
+
+    if (i != slots.size())
+    {
+        slots[i].node->value->second = std::forward<M>(obj);
+
+        return { iterator(slots[i].node, &tree), false };
+    }
+
+    auto result = tree.try_emplace(key, std::forward<M>(obj));
+    index(result.first.node, h);
+
+    return result;
+}
+
+// Erases element with the key
+// O(log(n)) amortized, the tree is not searched for the key
+template<class Key, class T, class Hash, class Compare, class SplayPolicy>
+size_t hashed_splay_map<Key, T, Hash, Compare, SplayPolicy>::erase(const Key& key)
+{
+    size_t i = probe(key, hasher(key));
+
+    if (i == slots.size())
+        return (size_t)0;
+
+    node_type* node = slots[i].node;
+
+    unindex(i);
+    tree.erase(iterator(node, &tree));
+
+    return (size_t)1;
+}
+
+// Erases all elements with keys in [lo, hi)
+// O(log(n) + k) amortized for k erased elements
+template<class Key, class T, class Hash, class Compare, class SplayPolicy>
+size_t hashed_splay_map<Key, T, Hash, Compare, SplayPolicy>::erase_range(const Key& lo, const Key& hi)
+{
+    auto middle = tree.extract_range(lo, hi);
+
+    for (auto it = middle.begin(); it != middle.end(); ++it)
+        unindex(probe(it->first, hasher(it->first)));
+
+    return middle.size();
+}
+
+// Returns pointer to element with the key or nullptr if there is no such key
+// O(1) expected, doesn't splay
+template<class Key, class T, class Hash, class Compare, class SplayPolicy>
+typename hashed_splay_map<Key, T, Hash, Compare, SplayPolicy>::value_type* hashed_splay_map<Key, T, Hash, Compare, SplayPolicy>::find(const Key& key) const
+{
+    size_t i = probe(key, hasher(key));
+
+    return (i != slots.size()) ? slots[i].node->value : nullptr;
+}
+
+// Returns weather the key exists (true) or not (false)
+// O(1) expected, doesn't splay
+template<class Key, class T, class Hash, class Compare, class SplayPolicy>
+bool hashed_splay_map<Key, T, Hash, Compare, SplayPolicy>::contains(const Key& key) const
+{
+    return find(key) != nullptr;
+}
+
+// Returns iterator of the first element with key not less than the key or end() if there is no such element
+// O(log(n)) amortized
+template<class Key, class T, class Hash, class Compare, class SplayPolicy>
+typename hashed_splay_map<Key, T, Hash, Compare, SplayPolicy>::iterator hashed_splay_map<Key, T, Hash, Compare, SplayPolicy>::lower_bound(const Key& key)
+{
+    return tree.lower_bound(key);
+}
+
+// Returns weather map is empty (true) or not (false)
+// O(1)
+template<class Key, class T, class Hash, class Compare, class SplayPolicy>
+bool hashed_splay_map<Key, T, Hash, Compare, SplayPolicy>::empty() const
+{
+    return tree.empty();
+}
+
+// Returns number of elements
+// O(1)
+template<class Key, class T, class Hash, class Compare, class SplayPolicy>
+size_t hashed_splay_map<Key, T, Hash, Compare, SplayPolicy>::size() const
+{
+    return tree.size();
+}
+
+// Returns iterator to the element with the smallest key
+// O(log(n))
+template<class Key, class T, class Hash, class Compare, class SplayPolicy>
+typename hashed_splay_map<Key, T, Hash, Compare, SplayPolicy>::iterator hashed_splay_map<Key, T, Hash, Compare, SplayPolicy>::begin() const
+{
+    return tree.begin();
+}
+
+// Returns iterator to the end of the map
+// O(1)
+template<class Key, class T, class Hash, class Compare, class SplayPolicy>
+typename hashed_splay_map<Key, T, Hash, Compare, SplayPolicy>::iterator hashed_splay_map<Key, T, Hash, Compare, SplayPolicy>::end() const
+{
+    return tree.end();
+}
+
+// Returns memory used by the hash index in bytes
+// O(1)
+template<class Key, class T, class Hash, class Compare, class SplayPolicy>
+size_t hashed_splay_map<Key, T, Hash, Compare, SplayPolicy>::index_bytes() const
+{
+    return slots.capacity() * sizeof(slot_type);
+}
+
+// private:
+
+// Returns index of the slot with the key or slots.size() if there is no such key
+// O(1) expected
+template<class Key, class T, class Hash, class Compare, class SplayPolicy>
+size_t hashed_splay_map<Key, T, Hash, Compare, SplayPolicy>::probe(const Key& key, size_t h) const
+{
+    if (slots.empty())
+        return slots.size();
+
+    const size_t mask = slots.size() - 1;
+
+    for (size_t i = h & mask; slots[i].node != nullptr; i = (i + 1) & mask)
+        if (slots[i].hash == h && equal(slots[i].node->value->first, key))
+            return i;
+
+    return slots.size();
+}
+
+// Adds element which is not indexed yet
+// O(1) amortized
+template<class Key, class T, class Hash, class Compare, class SplayPolicy>
+void hashed_splay_map<Key, T, Hash, Compare, SplayPolicy>::index(typename hashed_splay_map<Key, T, Hash, Compare, SplayPolicy>::node_type* node, size_t h)
+{
+    // tree already holds the new element
+    if (2 * tree.size() > slots.size())
+        grow();
+
+    const size_t mask = slots.size() - 1;
+
+    size_t i = h & mask;
+    while (slots[i].node != nullptr)
+        i = (i + 1) & mask;
+
+    slots[i] = slot_type{ h, node };
+}
+
+// Removes the element in the slot i, shifts back the following elements of its probe sequence
+// O(1) expected
+template<class Key, class T, class Hash, class Compare, class SplayPolicy>
+void hashed_splay_map<Key, T, Hash, Compare, SplayPolicy>::unindex(size_t i)
+{
+    const size_t mask = slots.size() - 1;
+
+    for (size_t j = (i + 1) & mask; slots[j].node != nullptr; j = (j + 1) & mask)
+    {
+        size_t home = slots[j].hash & mask;
+
+        // slot j can move to the hole at i if its home is not in the cyclic range (i, j]
+        if (((j - home) & mask) >= ((j - i) & mask))
+        {
+            slots[i] = slots[j];
+            i = j;
+        }
+    }
+
+    slots[i].node = nullptr;
+}
+
+// Doubles the number of slots and reinserts all indexed elements
+// O(n)
+template<class Key, class T, class Hash, class Compare, class SplayPolicy>
+void hashed_splay_map<Key, T, Hash, Compare, SplayPolicy>::grow()
+{
+    std::vector<slot_type> old_slots(slots.empty() ? 16 : 2 * slots.size(), slot_type{ 0, nullptr });
+    slots.swap(old_slots);
+
+    const size_t mask = slots.size() - 1;
+
+    for (const slot_type& s : old_slots)
+    {
+        if (s.node == nullptr)
+            continue;
+
+        size_t i = s.hash & mask;
+        while (slots[i].node != nullptr)
+            i = (i + 1) & mask;
+
+        slots[i] = s;
+    }
+}
+
+// Returns weather the keys are equivalent under Compare
+// O(1)
+template<class Key, class T, class Hash, class Compare, class SplayPolicy>
+bool hashed_splay_map<Key, T, Hash, Compare, SplayPolicy>::equal(const Key& a, const Key& b) const
+{
+    return !comp(a, b) && !comp(b, a);
+}
@@ -0,0 +1,552 @@
+//
+// "persistent_splay_tree.h" is a library with persistent (path-copying) splay tree implementation
+//
+
+#pragma once
+
+#include <utility>
+#include <cstddef>
+#include <vector>
+#include <atomic>
+#include <mutex>
+#include <functional>
+
+#include "splay_compare.h"
+
+
+// Persistent splay tree structure
+//
+// Every modification of the live version (insert, erase and splaying find) restructures the accessed
+// path in place while no snapshot references it. Nodes shared with a snapshot are copied first
+// (copy on write), untouched subtrees are shared between versions.
+// Nodes are reference-counted and freed when the last version that contains them is released.
+//
+// snapshot() returns read-only view of the current version in O(1). Views never splay, so any
+// number of threads can traverse them without locks while one writer keeps modifying the live version.
+// Writers have to be serialized by the user, snapshot() itself is safe to call from any thread
+// and waits for a running modification of the live version.
+//
+// Nodes have no parent pointers (they would prevent sharing), splaying uses the copied path instead
+//
+// type Key requirements:
+//		* copy constructor
+// 		* overloaded < or > (less or greater operator) or specify comparation rule as Compare type
+//
+// type T requirements:
+//		* copy constructor
+//
+
+template<class Key, class T, class Compare = std::less<>>
+class persistent_splay_tree
+{
+public:
+    typedef std::pair<const Key, T> value_type;
+private:
+    struct node_type
+    {
+        value_type value;
+
+        node_type* l_child;
+        node_type* r_child;
+
+        size_t size; // number of nodes in the subtree
+
+        std::atomic<size_t> refs; // number of parents and versions referencing the node
+    };
+public:
+    class snapshot_type
+    {
+        friend class persistent_splay_tree;
+    public:
+        snapshot_type() : snapshot_type(nullptr, Compare{}) {}
+        snapshot_type(const snapshot_type& other) : snapshot_type(acquire(other.root), other.comp) {}
+        snapshot_type(snapshot_type&& other) : snapshot_type(other.root, other.comp) { other.root = nullptr; }
+        ~snapshot_type() { release(root); }
+
+        snapshot_type& operator= (snapshot_type other) { std::swap(root, other.root); std::swap(comp, other.comp); return *this; }
+
+        const value_type* find(const Key& key) const;
+        const value_type* lower_bound(const Key& key) const;
+        bool contains(const Key& key) const;
+
+        template<class F>
+        void for_each(F f) const;
+
+        bool empty() const { return root == nullptr; }
+        size_t size() const { return subtree_size(root); }
+
+    private:
+        snapshot_type(node_type* root, Compare comp) : root(root), comp(comp) {}
+
+        node_type* root;
+
+        Compare comp;
+    };
+
+    persistent_splay_tree(Compare comp = Compare{});
+    persistent_splay_tree(const persistent_splay_tree&) = delete;
+    ~persistent_splay_tree();
+
+    persistent_splay_tree& operator= (const persistent_splay_tree&) = delete;
+
+    bool insert(const value_type& value);
+    size_t erase(const Key& key);
+    const value_type* find(const Key& key);
+
+    snapshot_type snapshot() const;
+
+    bool empty() const;
+    size_t size() const;
+private:
+    node_type* splay_copy(node_type* v, const Key& key, int& c);
+    node_type* splay_copy_max(node_type* v);
+    static void splay_path(std::vector<node_type*>& path);
+
+    static node_type* copy_owned(node_type* v);
+    static node_type* acquire(node_type* v);
+    static void release(node_type* v);
+
+    static void rotate_right(node_type* p);
+    static void rotate_left(node_type* p);
+
+    static size_t subtree_size(const node_type* n);
+    static void update_size(node_type* n);
+
+
+    node_type* root;
+
+    mutable std::mutex root_mutex; // guards modifications of the live version and acquiring of the root
+
+    std::vector<node_type*> path; // path buffer reused by splaying
+
+    Compare comp;
+};
+
+
+
+// Returns pointer to element with the key or nullptr if there is no such key
+// O(log(n)) amortized, doesn't splay
+template<class Key, class T, class Compare>
+const typename persistent_splay_tree<Key, T, Compare>::value_type* persistent_splay_tree<Key, T, Compare>::snapshot_type::find(const Key& key) const
+{
+    const value_type* bound = lower_bound(key);
+
+    if (bound == nullptr || comp(key, bound->first))
+        return nullptr;
+
+    return bound;
+}
+
+// Returns pointer to the first element with key not less than the key or nullptr if there is no such element
+// O(log(n)) amortized, doesn't splay
+template<class Key, class T, class Compare>
+const typename persistent_splay_tree<Key, T, Compare>::value_type* persistent_splay_tree<Key, T, Compare>::snapshot_type::lower_bound(const Key& key) const
+{
+    const value_type* bound = nullptr;
+
+    for (const node_type* v = root; v != nullptr;)
+    {
+        if (comp(v->value.first, key))
+            v = v->r_child;
+        else
+        {
+            bound = &v->value;
+            v = v->l_child;
+        }
+    }
+
+    return bound;
+}
+
+// Returns weather the key exists (true) or not (false)
+// O(log(n)) amortized, doesn't splay
+template<class Key, class T, class Compare>
+bool persistent_splay_tree<Key, T, Compare>::snapshot_type::contains(const Key& key) const
+{
+    return find(key) != nullptr;
+}
+
+// Calls f(const value_type&) for every element in key order
+// O(n)
+template<class Key, class T, class Compare>
+template<class F>
+void persistent_splay_tree<Key, T, Compare>::snapshot_type::for_each(F f) const
+{
+    std::vector<const node_type*> path;
+    const node_type* v = root;
+
+    while (v != nullptr || !path.empty())
+    {
+        for (; v != nullptr; v = v->l_child)
+            path.push_back(v);
+
+        v = path.back(); path.pop_back();
+        f(v->value);
+
+        v = v->r_child;
+    }
+}
+
+// public:
+template<class Key, class T, class Compare>
+persistent_splay_tree<Key, T, Compare>::persistent_splay_tree(Compare comp)
+{
+    root = nullptr;
+    this->comp = comp;
+}
+
+template<class Key, class T, class Compare>
+persistent_splay_tree<Key, T, Compare>::~persistent_splay_tree()
+{
+    release(root);
+}
+
+// Inserts value in the live version
+// Returns true if insertion is successidied and false if the key already exists
+// O(log(n)) amortized, copies only the nodes shared with snapshots
+template<class Key, class T, class Compare>
+bool persistent_splay_tree<Key, T, Compare>::insert(const value_type& value)
+{
+    std::lock_guard<std::mutex> lock(root_mutex);
+
+    int c = 1;
+    node_type* r = root = splay_copy(root, value.first, c);
+
+    if (r != nullptr && c == 0)
+        return false;
+
+    node_type* new_v = new node_type{ value, nullptr, nullptr, 1, { 1 } };
+
+    // r is owned by the live version only: the closest key to the new one
+    if (r != nullptr)
+    {
+        if (c < 0)
+        {
+            new_v->l_child = r->l_child;
+            new_v->r_child = r;
+            r->l_child = nullptr;
+        }
+        else
+        {
+            new_v->r_child = r->r_child;
+            new_v->l_child = r;
+            r->r_child = nullptr;
+        }
+
+        update_size(r);
+        update_size(new_v);
+    }
+
+    root = new_v;
+
+    return true;
+}
+
+// Erases node with the key from the live version
+// O(log(n)) amortized, copies only the nodes shared with snapshots
+template<class Key, class T, class Compare>
+size_t persistent_splay_tree<Key, T, Compare>::erase(const Key& key)
+{
+    std::lock_guard<std::mutex> lock(root_mutex);
+
+    int c = 1;
+    node_type* r = root = splay_copy(root, key, c);
+
+    if (r == nullptr || c != 0)
+        return (size_t)0;
+
+    // r is owned by the live version only, its children references are moved to the new root
+    node_type* l_root = r->l_child;
+    node_type* r_root = r->r_child;
+
+    delete r;
+
+    if (l_root == nullptr)
+        root = r_root;
+    else
+    {
+        l_root = splay_copy_max(l_root);
+
+        l_root->r_child = r_root;
+        update_size(l_root);
+
+        root = l_root;
+    }
+
+    return (size_t)1;
+}
+
+// Finds element with the key in the live version and splays it
+// Returns pointer to the element, valid until the next modification of the live version, or nullptr
+// O(log(n)) amortized, copies only the nodes shared with snapshots
+template<class Key, class T, class Compare>
+const typename persistent_splay_tree<Key, T, Compare>::value_type* persistent_splay_tree<Key, T, Compare>::find(const Key& key)
+{
+    std::lock_guard<std::mutex> lock(root_mutex);
+
+    int c = 1;
+    node_type* r = root = splay_copy(root, key, c);
+
+    return (r != nullptr && c == 0) ? &r->value : nullptr;
+}
+
+// Returns read-only view of the current version
+// Safe to call concurrently with modifications of the live version
+// O(1)
+template<class Key, class T, class Compare>
+typename persistent_splay_tree<Key, T, Compare>::snapshot_type persistent_splay_tree<Key, T, Compare>::snapshot() const
+{
+    std::lock_guard<std::mutex> lock(root_mutex);
+
+    return snapshot_type(acquire(root), comp);
+}
+
+// Returns weather splay tree is empty (true) or not (false)
+// O(1)
+template<class Key, class T, class Compare>
+bool persistent_splay_tree<Key, T, Compare>::empty() const
+{
+    return (root == nullptr);
+}
+
+// Returns number of elements in the live version
+// O(1)
+template<class Key, class T, class Compare>
+size_t persistent_splay_tree<Key, T, Compare>::size() const
+{
+    return subtree_size(root);
+}
+
+// private:
+
+// Takes the path from the owned subtree root v to the key, copying its shared nodes, and splays the last node
+// Returns owned root of the new subtree, c is the comparison of the key with the new root's key
+// O(log(n)) amortized
+template<class Key, class T, class Compare>
+typename persistent_splay_tree<Key, T, Compare>::node_type* persistent_splay_tree<Key, T, Compare>::splay_copy(typename persistent_splay_tree<Key, T, Compare>::node_type* v, const Key& key, int& c)
+{
+    if (v == nullptr)
+        return nullptr;
+
+    path.clear();
+    path.push_back(copy_owned(v));
+
+    while (true)
+    {
+        node_type* x = path.back();
+
+        c = three_way_compare(comp, key, x->value.first);
+
+        node_type*& child = (c < 0) ? x->l_child : x->r_child;
+
+        if (c == 0 || child == nullptr)
+            break;
+
+        child = copy_owned(child);
+        path.push_back(child);
+    }
+
+    splay_path(path);
+
+    return path.back();
+}
+
+// Takes the path from the owned subtree root v to its greatest key, copying its shared nodes, and splays it
+// Returns owned root of the new subtree, which has no right child
+// O(log(n)) amortized
+template<class Key, class T, class Compare>
+typename persistent_splay_tree<Key, T, Compare>::node_type* persistent_splay_tree<Key, T, Compare>::splay_copy_max(typename persistent_splay_tree<Key, T, Compare>::node_type* v)
+{
+    path.clear();
+    path.push_back(copy_owned(v));
+
+    while (path.back()->r_child != nullptr)
+    {
+        path.back()->r_child = copy_owned(path.back()->r_child);
+        path.push_back(path.back()->r_child);
+    }
+
+    splay_path(path);
+
+    return path.back();
+}
+
+// Splays the last node of the path of owned nodes (path[i + 1] is a child of path[i]) to the top
+// All nodes of the path can be changed in place, the splayed node is moved to path.back()
+// O(path length)
+template<class Key, class T, class Compare>
+void persistent_splay_tree<Key, T, Compare>::splay_path(std::vector<node_type*>& path)
+{
+    node_type* x = path.back();
+    size_t i = path.size() - 1;
+
+    while (i > 0)
+    {
+        node_type* p = path[i - 1];
+
+        if (i == 1) // zig
+        {
+            if (p->l_child == x)
+                rotate_right(p);
+            else
+                rotate_left(p);
+
+            i = 0;
+        }
+        else
+        {
+            node_type* g = path[i - 2];
+
+            if (g->l_child == p)
+            {
+                if (p->l_child == x) // zig-zig
+                {
+                    rotate_right(g);
+                    rotate_right(p);
+                }
+                else // zig-zag
+                {
+                    rotate_left(p);
+                    g->l_child = x;
+                    rotate_right(g);
+                }
+            }
+            else
+            {
+                if (p->r_child == x) // zig-zig
+                {
+                    rotate_left(g);
+                    rotate_left(p);
+                }
+                else // zig-zag
+                {
+                    rotate_right(p);
+                    g->r_child = x;
+                    rotate_left(g);
+                }
+            }
+
+            i -= 2;
+        }
+
+        // x took the place of path[i], link it to the great-grandparent
+        if (i > 0)
+        {
+            node_type* gg = path[i - 1];
+
+            if (gg->l_child == path[i])
+                gg->l_child = x;
+            else
+                gg->r_child = x;
+
+            update_size(gg);
+        }
+    }
+
+    // sizes of the remaining ancestors are unchanged, x is the new top
+    path.back() = x;
+}
+
+// Returns node with the contents of the owned node v that can be changed in place
+// v itself if the caller holds the only reference, otherwise its copy referencing the same children
+// O(1)
+template<class Key, class T, class Compare>
+typename persistent_splay_tree<Key, T, Compare>::node_type* persistent_splay_tree<Key, T, Compare>::copy_owned(typename persistent_splay_tree<Key, T, Compare>::node_type* v)
+{
+    // the path is reached through owned nodes, so a single reference means that only the live version has v
+    if (v->refs.load(std::memory_order_acquire) == 1)
+        return v;
+
+    node_type* x = new node_type{ v->value, acquire(v->l_child), acquire(v->r_child), v->size, { 1 } };
+
+    release(v);
+
+    return x;
+}
+
+// Adds reference to the node
+// O(1)
+template<class Key, class T, class Compare>
+typename persistent_splay_tree<Key, T, Compare>::node_type* persistent_splay_tree<Key, T, Compare>::acquire(typename persistent_splay_tree<Key, T, Compare>::node_type* v)
+{
+    if (v != nullptr)
+        v->refs.fetch_add(1, std::memory_order_relaxed);
+
+    return v;
+}
+
+// Removes reference to the node and frees nodes that are not referenced anymore
+// O(1) plus O(k) for freeing k nodes
+template<class Key, class T, class Compare>
+void persistent_splay_tree<Key, T, Compare>::release(typename persistent_splay_tree<Key, T, Compare>::node_type* v)
+{
+    std::vector<node_type*> q;
+
+    if (v != nullptr)
+        q.push_back(v);
+
+    while (!q.empty())
+    {
+        v = q.back(); q.pop_back();
+
+        if (v->refs.fetch_sub(1, std::memory_order_acq_rel) != 1)
+            continue;
+
+        if (v->l_child != nullptr)
+            q.push_back(v->l_child);
+        if (v->r_child != nullptr)
+            q.push_back(v->r_child);
+
+        delete v;
+    }
+}
+
+// right turn over the node: its left child takes its place
+// O(1)
+template<class Key, class T, class Compare>
+void persistent_splay_tree<Key, T, Compare>::rotate_right(typename persistent_splay_tree<Key, T, Compare>::node_type* p)
+{
+    // x = p->l_child
+    // the caller links x to p's parent
+
+    node_type* x = p->l_child;
+
+    p->l_child = x->r_child;
+    x->r_child = p;
+
+    update_size(p);
+    update_size(x);
+}
+
+// left turn over the node: its right child takes its place
+// O(1)
+template<class Key, class T, class Compare>
+void persistent_splay_tree<Key, T, Compare>::rotate_left(typename persistent_splay_tree<Key, T, Compare>::node_type* p)
+{
+    // x = p->r_child
+    // the caller links x to p's parent
+
+    node_type* x = p->r_child;
+
+    p->r_child = x->l_child;
+    x->l_child = p;
+
+    update_size(p);
+    update_size(x);
+}
+
+// Returns number of nodes in the subtree (0 for nullptr)
+// O(1)
+template<class Key, class T, class Compare>
+size_t persistent_splay_tree<Key, T, Compare>::subtree_size(const typename persistent_splay_tree<Key, T, Compare>::node_type* n)
+{
+    return (n != nullptr) ? n->size : 0;
+}
+
+// Recalculates size of the node from its children
+// O(1)
+template<class Key, class T, class Compare>
+void persistent_splay_tree<Key, T, Compare>::update_size(typename persistent_splay_tree<Key, T, Compare>::node_type* n)
+{
+    n->size = 1 + subtree_size(n->l_child) + subtree_size(n->r_child);
+}
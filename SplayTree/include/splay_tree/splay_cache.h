@@ -0,0 +1,361 @@
+//
+// "splay_cache.h" is a library with capacity-bounded cache built on splay tree
+//
+
+#pragma once
+
+#include "splay_tree.h"
+
+#include <cstddef>
+#include <utility>
+#include <functional>
+#include <stdexcept>
+
+
+// Weight of a cache entry for count-based capacity
+struct splay_cache_unit_weight
+{
+    template<class Key, class T>
+    size_t operator() (const Key&, const T&) const { return 1; }
+};
+
+// Cache hit/miss statistics
+struct splay_cache_stats
+{
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+
+    double hit_rate() const { return (hits + misses != 0) ? (double)hits / (double)(hits + misses) : 0.0; }
+};
+
+
+// Splay cache structure
+//
+// Entries are kept in a splay tree, so recently accessed keys stay near the root,
+// and in a LRU list threaded through the tree nodes, which decides what is evicted
+// when the total weight of entries exceeds capacity. Evicted and erased nodes are
+// unlinked from the tree directly, without a search by key.
+//
+// Weigher returns the weight of an entry: 1 per entry by default (capacity is
+// the number of entries), or e.g. a byte size of the value for byte-based capacity
+//
+// type Key requirements:
+//		* copy constructor
+// 		* overloaded < or > (less or greater operator) or specify comparation rule as Compare type
+//
+
+template<class Key, class T, class Compare = std::less<>, class Weigher = splay_cache_unit_weight>
+class splay_cache
+{
+private:
+    struct entry;
+    typedef splay_tree<Key, entry, Compare> tree_type;
+    typedef typename tree_type::node_type node_type;
+
+    struct entry
+    {
+        entry(const T& value, size_t weight) : value(value), weight(weight), prev(nullptr), next(nullptr) {}
+
+        T value;
+        size_t weight;
+
+        // LRU list, from the most to the least recently used entry
+        node_type* prev;
+        node_type* next;
+    };
+public:
+    splay_cache(size_t capacity, Weigher weigher = Weigher{}, Compare comp = Compare{});
+    splay_cache(const splay_cache&) = delete;
+    splay_cache(splay_cache&& other);
+
+    splay_cache& operator= (const splay_cache&) = delete;
+    splay_cache& operator= (splay_cache&& other);
+
+    T* get(const Key& key);
+    bool put(const Key& key, const T& value);
+    bool erase(const Key& key);
+
+    bool empty() const;
+    size_t size() const;
+    size_t weight() const;
+    size_t capacity() const;
+
+    const splay_cache_stats& stats() const;
+    void reset_stats();
+private:
+    void unlink(node_type* x);
+    void push_front(node_type* x);
+    void evict();
+
+    static entry& entry_of(node_type* x);
+
+
+    tree_type tree;
+
+    node_type* head; // the most recently used entry
+    node_type* tail; // the least recently used entry
+
+    size_t total_weight;
+    size_t max_weight;
+
+    splay_cache_stats counters;
+
+    Weigher weigher;
+};
+
+
+
+// public:
+template<class Key, class T, class Compare, class Weigher>
+splay_cache<Key, T, Compare, Weigher>::splay_cache(size_t capacity, Weigher weigher, Compare comp) : tree(comp)
+{
+    head = tail = nullptr;
+
+    total_weight = 0;
+    max_weight = capacity;
+
+    this->weigher = weigher;
+}
+
+// Takes entries of the other cache, which is left empty
+// O(1)
+template<class Key, class T, class Compare, class Weigher>
+splay_cache<Key, T, Compare, Weigher>::splay_cache(splay_cache&& other) : tree(std::move(other.tree))
+{
+    head = other.head;
+    tail = other.tail;
+
+    total_weight = other.total_weight;
+    max_weight = other.max_weight;
+
+    counters = other.counters;
+    weigher = other.weigher;
+
+    other.head = other.tail = nullptr;
+    other.total_weight = 0;
+}
+
+// Takes entries of the other cache, which is left empty, erases own entries
+// O(n)
+template<class Key, class T, class Compare, class Weigher>
+splay_cache<Key, T, Compare, Weigher>& splay_cache<Key, T, Compare, Weigher>::operator=(splay_cache&& other)
+{
+    if (this != &other)
+    {
+        tree = std::move(other.tree);
+
+        head = other.head;
+        tail = other.tail;
+
+        total_weight = other.total_weight;
+        max_weight = other.max_weight;
+
+        counters = other.counters;
+        weigher = other.weigher;
+
+        other.head = other.tail = nullptr;
+        other.total_weight = 0;
+    }
+
+    return *this;
+}
+
+// Returns pointer to the cached value and marks it as the most recently used, nullptr if there is no such key
+// O(log(n)) amortized
+template<class Key, class T, class Compare, class Weigher>
+T* splay_cache<Key, T, Compare, Weigher>::get(const Key& key)
+{
+    auto it = tree.find(key);
+
+    if (it == tree.end())
+    {
+        ++counters.misses;
+
+        return nullptr;
+    }
+
+    ++counters.hits;
+
+    node_type* x = it.node;
+    if (x != head)
+    {
+        unlink(x);
+        push_front(x);
+    }
+
+    return &entry_of(x).value;
+}
+
+// Inserts or updates the value and evicts the least recently used entries while weight exceeds capacity
+// Returns false (and drops the key) if the entry alone is heavier than capacity
+// O(log(n)) amortized per inserted or evicted entry
+template<class Key, class T, class Compare, class Weigher>
+bool splay_cache<Key, T, Compare, Weigher>::put(const Key& key, const T& value)
+{
+    size_t w = weigher(key, value);
+
+    if (w > max_weight)
+    {
+        erase(key);
+
+        return false;
+    }
+
+    // the entry (and the value) is constructed only if the key is not cached yet
+    auto result = tree.try_emplace(key, value, w);
+    node_type* x = result.first.node;
+
+    if (result.second)
+    {
+        total_weight += w;
+        push_front(x);
+    }
+    else
+    {
+        total_weight = total_weight - entry_of(x).weight + w;
+        entry_of(x).value = value;
+        entry_of(x).weight = w;
+
+        if (x != head)
+        {
+            unlink(x);
+            push_front(x);
+        }
+    }
+
+    while (total_weight > max_weight)
+        evict();
+
+    return true;
+}
+
+// Erases the entry with the key
+// Returns whether the key was cached
+// O(log(n)) amortized
+template<class Key, class T, class Compare, class Weigher>
+bool splay_cache<Key, T, Compare, Weigher>::erase(const Key& key)
+{
+    auto it = tree.find(key);
+
+    if (it == tree.end())
+        return false;
+
+    unlink(it.node);
+    total_weight -= it->second.weight;
+
+    tree.erase(it);
+
+    return true;
+}
+
+// Returns weather cache is empty (true) or not (false)
+// O(1)
+template<class Key, class T, class Compare, class Weigher>
+bool splay_cache<Key, T, Compare, Weigher>::empty() const
+{
+    return tree.empty();
+}
+
+// Returns number of cached entries
+// O(1)
+template<class Key, class T, class Compare, class Weigher>
+size_t splay_cache<Key, T, Compare, Weigher>::size() const
+{
+    return tree.size();
+}
+
+// Returns total weight of cached entries
+// O(1)
+template<class Key, class T, class Compare, class Weigher>
+size_t splay_cache<Key, T, Compare, Weigher>::weight() const
+{
+    return total_weight;
+}
+
+// Returns maximum total weight of cached entries
+// O(1)
+template<class Key, class T, class Compare, class Weigher>
+size_t splay_cache<Key, T, Compare, Weigher>::capacity() const
+{
+    return max_weight;
+}
+
+// Returns hit/miss statistics
+// O(1)
+template<class Key, class T, class Compare, class Weigher>
+const splay_cache_stats& splay_cache<Key, T, Compare, Weigher>::stats() const
+{
+    return counters;
+}
+
+// Resets hit/miss statistics
+// O(1)
+template<class Key, class T, class Compare, class Weigher>
+void splay_cache<Key, T, Compare, Weigher>::reset_stats()
+{
+    counters = splay_cache_stats();
+}
+
+// private:
+
+// Removes entry from the LRU list
+// O(1)
+template<class Key, class T, class Compare, class Weigher>
+void splay_cache<Key, T, Compare, Weigher>::unlink(typename splay_cache<Key, T, Compare, Weigher>::node_type* x)
+{
+    entry& e = entry_of(x);
+
+    if (e.prev != nullptr)
+        entry_of(e.prev).next = e.next;
+    else
+        head = e.next;
+
+    if (e.next != nullptr)
+        entry_of(e.next).prev = e.prev;
+    else
+        tail = e.prev;
+
+    e.prev = e.next = nullptr;
+}
+
+// Puts entry at the beginning (the most recently used end) of the LRU list
+// O(1)
+template<class Key, class T, class Compare, class Weigher>
+void splay_cache<Key, T, Compare, Weigher>::push_front(typename splay_cache<Key, T, Compare, Weigher>::node_type* x)
+{
+    entry_of(x).prev = nullptr;
+    entry_of(x).next = head;
+
+    if (head != nullptr)
+        entry_of(head).prev = x;
+    else
+        tail = x;
+
+    head = x;
+}
+
+// Erases the least recently used entry through its node, without a search by key
+// O(log(n)) amortized
+template<class Key, class T, class Compare, class Weigher>
+void splay_cache<Key, T, Compare, Weigher>::evict()
+{
+    if (tail == nullptr)
+        throw std::underflow_error("Can't evict entry from an empty cache.");
+
+    node_type* x = tail;
+
+    unlink(x);
+    total_weight -= entry_of(x).weight;
+    ++counters.evictions;
+
+    tree.erase(typename tree_type::iterator(x, &tree));
+}
+
+// Returns the cache entry of the tree node
+// O(1)
+template<class Key, class T, class Compare, class Weigher>
+typename splay_cache<Key, T, Compare, Weigher>::entry& splay_cache<Key, T, Compare, Weigher>::entry_of(typename splay_cache<Key, T, Compare, Weigher>::node_type* x)
+{
+    return x->value->second;
+}
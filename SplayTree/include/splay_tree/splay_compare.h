@@ -0,0 +1,73 @@
+//
+// "splay_compare.h" is a library with three-way key comparison shared by splay trees
+//
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <functional>
+#include <type_traits>
+
+#if __cplusplus > 201703L && __has_include(<compare>) && __has_include(<concepts>)
+#include <compare>
+#include <concepts>
+#endif
+
+
+// Whether Compare is std::less (std::greater) of any type, which orders keys by their < (>) operator
+template<class Compare>
+struct is_std_less : std::false_type {};
+template<class U>
+struct is_std_less<std::less<U>> : std::true_type {};
+
+template<class Compare>
+struct is_std_greater : std::false_type {};
+template<class U>
+struct is_std_greater<std::greater<U>> : std::true_type {};
+
+// std::basic_string_view viewing K if K is std::basic_string or std::basic_string_view, void otherwise
+template<class K>
+struct string_view_of { typedef void type; };
+template<class C, class Traits, class Alloc>
+struct string_view_of<std::basic_string<C, Traits, Alloc>> { typedef std::basic_string_view<C, Traits> type; };
+template<class C, class Traits>
+struct string_view_of<std::basic_string_view<C, Traits>> { typedef std::basic_string_view<C, Traits> type; };
+
+
+// Compares keys with Compare: returns negative if a goes before b, positive if after and 0 if they are equivalent
+// Makes a single comparison for std::less and std::greater of:
+//		* strings and string views - one pass of basic_string_view::compare
+//		* types with <=> when compiled as C++20
+// Otherwise calls comp(a, b) and, only if a doesn't go before b, comp(b, a), so Key doesn't need operator==
+// O(1)
+template<class Compare, class K1, class K2>
+int three_way_compare(const Compare& comp, const K1& a, const K2& b)
+{
+    typedef typename string_view_of<K1>::type view_type;
+
+    constexpr bool strings = !std::is_void<view_type>::value && std::is_same<view_type, typename string_view_of<K2>::type>::value;
+    constexpr int direction = is_std_less<Compare>::value ? 1 : (is_std_greater<Compare>::value ? -1 : 0);
+
+    if constexpr (strings && direction != 0)
+    {
+        int c = view_type(a).compare(view_type(b));
+
+        return direction * ((c < 0) ? -1 : ((c > 0) ? 1 : 0));
+    }
+#if defined(__cpp_lib_three_way_comparison) && defined(__cpp_lib_concepts)
+    else if constexpr (direction != 0 && !std::is_pointer_v<K1> && !std::is_pointer_v<K2> && std::three_way_comparable_with<K1, K2>)
+    {
+        auto c = (a <=> b);
+
+        return direction * ((c < 0) ? -1 : ((c > 0) ? 1 : 0));
+    }
+#endif
+    else
+    {
+        if (comp(a, b))
+            return -1;
+
+        return comp(b, a) ? 1 : 0;
+    }
+}
@@ -0,0 +1,479 @@
+//
+// "splay_rope.h" is a library with implicit-key splay tree (rope) for sequence editing
+//
+
+#pragma once
+
+#include "splay_tree.h"
+
+#include <utility>
+#include <cstddef>
+#include <vector>
+#include <stdexcept>
+
+
+// Splay rope structure
+//
+// Sequence of elements kept in a splay tree ordered by position instead of key:
+// the position of a node is the size of everything to its left, so subtree sizes are the only index.
+// Insertion, erasure and access at any position, split and concatenation are O(log(n)) amortized.
+// reverse() marks the root of the range subtree, the mark is pushed down to children lazily
+// on the way of later descents, before any rotation below the marked node.
+//
+// Rotations and splaying are the same as in splay_tree (splay_zig_l, splay_zig_r, splay_to_root)
+//
+// type T requirements:
+//		* copy constructor
+//
+
+template<class T>
+class splay_rope
+{
+private:
+    struct node_type
+    {
+        T value;
+
+        node_type* parent;
+        node_type* l_child = nullptr, * r_child = nullptr;
+
+        size_t size = 1;        // number of nodes in the subtree
+        bool reversed = false;  // children of the whole subtree are to be swapped
+    };
+public:
+    splay_rope();
+    template<class InputIt>
+    splay_rope(InputIt first, InputIt last);
+    splay_rope(const splay_rope&) = delete;
+    splay_rope(splay_rope&& other);
+    ~splay_rope();
+
+    splay_rope& operator= (const splay_rope&) = delete;
+    splay_rope& operator= (splay_rope&& other);
+
+    void insert_at(size_t pos, const T& value);
+    void push_back(const T& value);
+    void erase_at(size_t pos);
+    T& at(size_t pos);
+
+    splay_rope split_at(size_t pos);
+    void concat(splay_rope& right);
+    void reverse(size_t first, size_t last);
+
+    template<class F>
+    void for_each(F f);
+
+    bool empty() const;
+    size_t size() const;
+private:
+    void splay(node_type* n);
+    void splay_at(size_t pos);
+    void splay_max();
+
+    static void push_down(node_type* n);
+    static node_type* build(const std::vector<node_type*>& nodes, size_t lo, size_t hi, node_type* parent);
+    static size_t subtree_size(const node_type* n);
+    static void update_size(node_type* n);
+    static void destroy(node_type* n);
+
+
+    node_type* root;
+};
+
+
+
+// public:
+template<class T>
+splay_rope<T>::splay_rope()
+{
+    root = nullptr;
+}
+
+// Builds balanced rope from the range
+// O(n)
+template<class T>
+template<class InputIt>
+splay_rope<T>::splay_rope(InputIt first, InputIt last) : splay_rope()
+{
+    std::vector<node_type*> nodes;
+
+    for (; first != last; ++first)
+        nodes.push_back(new node_type{ *first, nullptr });
+
+    root = build(nodes, 0, nodes.size(), nullptr);
+}
+
+template<class T>
+splay_rope<T>::splay_rope(splay_rope&& other)
+{
+    root = other.root;
+    other.root = nullptr;
+}
+
+template<class T>
+splay_rope<T>::~splay_rope()
+{
+    destroy(root);
+}
+
+template<class T>
+splay_rope<T>& splay_rope<T>::operator=(splay_rope&& other)
+{
+    if (this != &other)
+    {
+        destroy(root);
+
+        root = other.root;
+        other.root = nullptr;
+    }
+
+    return *this;
+}
+
+// Inserts value before the element at the position (at the end for pos == size())
+// Throws std::out_of_range if pos > size()
+// O(log(n)) amortized
+template<class T>
+void splay_rope<T>::insert_at(size_t pos, const T& value)
+{
+    if (pos > size())
+        throw std::out_of_range("splay_rope::insert_at position is out of range");
+
+    node_type* v = new node_type{ value, nullptr };
+
+    if (pos == size())
+    {
+        // the old tree becomes the left subtree
+        v->l_child = root;
+    }
+    else
+    {
+        splay_at(pos);
+
+        // root is the element at pos, the new element goes between its left subtree and it
+        v->l_child = root->l_child;
+        v->r_child = root;
+
+        root->l_child = nullptr;
+        update_size(root);
+    }
+
+    if (v->l_child != nullptr)
+        v->l_child->parent = v;
+    if (v->r_child != nullptr)
+        v->r_child->parent = v;
+
+    root = v;
+    update_size(root);
+}
+
+// Appends value to the end
+// O(1)
+template<class T>
+void splay_rope<T>::push_back(const T& value)
+{
+    insert_at(size(), value);
+}
+
+// Erases the element at the position
+// Throws std::out_of_range if pos >= size()
+// O(log(n)) amortized
+template<class T>
+void splay_rope<T>::erase_at(size_t pos)
+{
+    if (pos >= size())
+        throw std::out_of_range("splay_rope::erase_at position is out of range");
+
+    splay_at(pos);
+
+    node_type* v = root;
+    node_type* l_root = v->l_child;
+    node_type* r_root = v->r_child;
+
+    if (l_root == nullptr)
+    {
+        root = r_root;
+        if (root != nullptr)
+            root->parent = nullptr;
+    }
+    else
+    {
+        root = l_root; // left tree - main tree
+        root->parent = nullptr;
+
+        if (r_root != nullptr)
+        {
+            splay_max();
+
+            root->r_child = r_root;
+            r_root->parent = root;
+            update_size(root);
+        }
+    }
+
+    delete v;
+}
+
+// Returns the element at the position
+// Throws std::out_of_range if pos >= size()
+// O(log(n)) amortized
+template<class T>
+T& splay_rope<T>::at(size_t pos)
+{
+    if (pos >= size())
+        throw std::out_of_range("splay_rope::at position is out of range");
+
+    splay_at(pos);
+
+    return root->value;
+}
+
+// Moves elements at positions [pos, size()) to a new rope
+// Throws std::out_of_range if pos > size()
+// O(log(n)) amortized
+template<class T>
+splay_rope<T> splay_rope<T>::split_at(size_t pos)
+{
+    if (pos > size())
+        throw std::out_of_range("splay_rope::split_at position is out of range");
+
+    splay_rope right;
+
+    if (pos == size())
+        return right;
+
+    splay_at(pos);
+
+    // root is the first element of the right part
+    right.root = root;
+    root = root->l_child;
+
+    right.root->l_child = nullptr;
+    update_size(right.root);
+
+    if (root != nullptr)
+        root->parent = nullptr;
+
+    return right;
+}
+
+// Appends all elements of the right rope, which becomes empty
+// O(log(n)) amortized
+template<class T>
+void splay_rope<T>::concat(splay_rope& right)
+{
+    if (this == &right || right.root == nullptr)
+        return;
+
+    if (root == nullptr)
+    {
+        std::swap(root, right.root);
+        return;
+    }
+
+    splay_max();
+
+    root->r_child = right.root;
+    right.root->parent = root;
+    update_size(root);
+
+    right.root = nullptr;
+}
+
+// Reverses order of elements at positions [first, last)
+// Throws std::out_of_range if first > last or last > size()
+// O(log(n)) amortized
+template<class T>
+void splay_rope<T>::reverse(size_t first, size_t last)
+{
+    if (first > last || last > size())
+        throw std::out_of_range("splay_rope::reverse range is out of range");
+
+    if (last - first < 2)
+        return;
+
+    splay_rope middle = split_at(first);
+    splay_rope right = middle.split_at(last - first);
+
+    middle.root->reversed = !middle.root->reversed;
+
+    concat(middle);
+    concat(right);
+}
+
+// Calls f(T&) for every element in sequence order
+// O(n)
+template<class T>
+template<class F>
+void splay_rope<T>::for_each(F f)
+{
+    std::vector<node_type*> path;
+    node_type* v = root;
+
+    while (v != nullptr || !path.empty())
+    {
+        for (; v != nullptr; v = v->l_child)
+        {
+            push_down(v);
+            path.push_back(v);
+        }
+
+        v = path.back(); path.pop_back();
+        f(v->value);
+
+        v = v->r_child;
+    }
+}
+
+// Returns weather rope is empty (true) or not (false)
+// O(1)
+template<class T>
+bool splay_rope<T>::empty() const
+{
+    return (root == nullptr);
+}
+
+// Returns number of elements
+// O(1)
+template<class T>
+size_t splay_rope<T>::size() const
+{
+    return subtree_size(root);
+}
+
+// private:
+
+// ascend the node to the root, all its ancestors must have no pending reverse
+// O(log(n)) amortized
+template<class T>
+void splay_rope<T>::splay(typename splay_rope<T>::node_type* n)
+{
+    splay_to_root(n, root, [](node_type* y, node_type* x)
+    {
+        update_size(y);
+        update_size(x);
+    });
+}
+
+// Descends to the element at the position (pos < size()), pushing reverse marks down, and splays it
+// O(log(n)) amortized
+template<class T>
+void splay_rope<T>::splay_at(size_t pos)
+{
+    node_type* v = root;
+
+    while (true)
+    {
+        push_down(v);
+
+        size_t l_size = subtree_size(v->l_child);
+
+        if (pos < l_size)
+            v = v->l_child;
+        else if (pos > l_size)
+        {
+            pos -= l_size + 1;
+            v = v->r_child;
+        }
+        else
+            break;
+    }
+
+    splay(v);
+}
+
+// ascend the last element to the root
+// O(log(n)) amortized
+template<class T>
+void splay_rope<T>::splay_max()
+{
+    if (root == nullptr)
+        return;
+
+    node_type* max = root;
+    push_down(max);
+
+    while (max->r_child != nullptr)
+    {
+        max = max->r_child;
+        push_down(max);
+    }
+
+    splay(max);
+}
+
+// Applies pending reverse of the node: swaps its children and passes the mark to them
+// O(1)
+template<class T>
+void splay_rope<T>::push_down(typename splay_rope<T>::node_type* n)
+{
+    if (!n->reversed)
+        return;
+
+    std::swap(n->l_child, n->r_child);
+
+    if (n->l_child != nullptr)
+        n->l_child->reversed = !n->l_child->reversed;
+    if (n->r_child != nullptr)
+        n->r_child->reversed = !n->r_child->reversed;
+
+    n->reversed = false;
+}
+
+// Links nodes [lo, hi) into a balanced subtree
+// O(hi - lo)
+template<class T>
+typename splay_rope<T>::node_type* splay_rope<T>::build(const std::vector<node_type*>& nodes, size_t lo, size_t hi, typename splay_rope<T>::node_type* parent)
+{
+    if (lo == hi)
+        return nullptr;
+
+    size_t mid = lo + (hi - lo) / 2;
+    node_type* v = nodes[mid];
+
+    v->parent = parent;
+    v->l_child = build(nodes, lo, mid, v);
+    v->r_child = build(nodes, mid + 1, hi, v);
+    v->size = hi - lo;
+
+    return v;
+}
+
+// Returns number of nodes in the subtree (0 for nullptr)
+// O(1)
+template<class T>
+size_t splay_rope<T>::subtree_size(const typename splay_rope<T>::node_type* n)
+{
+    return (n != nullptr) ? n->size : 0;
+}
+
+// Recalculates size of the node from its children
+// O(1)
+template<class T>
+void splay_rope<T>::update_size(typename splay_rope<T>::node_type* n)
+{
+    n->size = 1 + subtree_size(n->l_child) + subtree_size(n->r_child);
+}
+
+// Frees all nodes of the subtree
+// O(n)
+template<class T>
+void splay_rope<T>::destroy(typename splay_rope<T>::node_type* n)
+{
+    std::vector<node_type*> q;
+
+    if (n != nullptr)
+        q.push_back(n);
+
+    while (!q.empty())
+    {
+        n = q.back(); q.pop_back();
+
+        if (n->l_child != nullptr)
+            q.push_back(n->l_child);
+        if (n->r_child != nullptr)
+            q.push_back(n->r_child);
+
+        delete n;
+    }
+}
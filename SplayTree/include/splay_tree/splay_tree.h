@@ -3,349 +3,306 @@
 // "splay_tree.h" is a library with splay tree data structure implementation
 //
 
+#pragma once
+
 #include <utility>
 #include <cstddef>
+#include <cstdint>
+#include <algorithm>
 #include <queue>
+#include <vector>
 #include <functional>
 #include <stdexcept>
+#include <type_traits>
+#include <tuple>
+#include <array>
+
+#include "splay_compare.h"
 
 
 // Splay tree structure
 //
+// SplayPolicy decides how accessed nodes are splayed (see splaying policies above)
+//
 // type Key requirements:
 //		* copy constructor
 // 		* overloaded < or > (less or greater operator) or specify comparation rule as Compare type
 //
+// If Compare::is_transparent is defined (as for default std::less<>), find, erase and extract
+// also accept any type comparable with Key, e.g. std::string_view for std::string keys
+//
 
-template<class Key, class T, class Compare = std::less<>>
-class splay_tree
-{
-public:
-    typedef std::pair<const Key, T> value_type;
-private:
-    struct node_type
-    {    
-        value_type* value;
+template<class Key, class T, class Compare>
+class frozen_splay_tree;
 
-        node_type* parent;
-        node_type* l_child = nullptr, * r_child = nullptr;
-    };
-public:
-    class iterator
-    {
-        friend class splay_tree;
-    public:
-        iterator() : iterator(nullptr, nullptr) {}
-        iterator(const iterator& it);
+template<class Key, class T, class Hash, class Compare, class SplayPolicy>
+class hashed_splay_map;
 
-        value_type* operator-> () { return node->value; }
-        value_type& operator* () { return (*node->value); }
+template<class Key, class T, class Compare, class Weigher>
+class splay_cache;
 
+template<class Key, class T, class Compare, class SplayPolicy>
+class splay_tree_dump;
 
-        friend bool operator!= (const iterator& it1, const iterator& it2);
-        
-    private:
-        iterator(node_type* node, const splay_tree* tree);
-        iterator(const splay_tree* tree) : iterator(nullptr, tree) {}
 
-        node_type* node;
-        const splay_tree* tree;
-    };
+// Splaying policies
+//
+// Decide whether the node reached by an access (find, insert, lower_bound, ...) is splayed and how.
+// Structural operations (erase, extract, split, join) always use full splay.
+// Policy requirements:
+//		* static constexpr bool semi - use semi-splay instead of full splay
+//		* static constexpr bool uses_depth - should_splay needs the depth of accessed node
+//		* static constexpr bool count_accesses - nodes keep access counters used by splay_tree::optimize()
+//		* static constexpr bool collect_stats - the tree counts rotations and depths of accesses for splay_tree::stats()
+//		* bool should_splay(size_t depth, size_t size) - depth of the accessed node and size of the tree
+//
 
-    splay_tree(Compare comp = Compare{});
-    ~splay_tree();
+// Full splay of every accessed node (classic splay tree)
+struct full_splay_policy
+{
+    static constexpr bool semi = false;
+    static constexpr bool uses_depth = false;
+    static constexpr bool count_accesses = false;
+    static constexpr bool collect_stats = false;
 
-    std::pair<iterator, bool> insert(const value_type& value);
-    size_t erase(const Key& key);
-    value_type extract(const Key& key);
-    iterator find(const Key& key);
+    bool should_splay(size_t, size_t) { return true; }
+};
 
-    bool empty() const;
-    iterator end() const;
-private:
-    node_type* _find(const Key& key);
+// Semi-splay of every accessed node: zig-zig steps rotate only the parent, so the accessed
+// node is moved about halfway to the root with about half of the rotations
+struct semi_splay_policy
+{
+    static constexpr bool semi = true;
+    static constexpr bool uses_depth = false;
+    static constexpr bool count_accesses = false;
+    static constexpr bool collect_stats = false;
 
-    void splay(node_type* n);
+    bool should_splay(size_t, size_t) { return true; }
+};
 
-    void zig_l(node_type* n);
-    void zig_r(node_type* n);
+// Full splay only when the accessed node is deeper than factor * log2(n)
+struct depth_threshold_splay_policy
+{
+    static constexpr bool semi = false;
+    static constexpr bool uses_depth = true;
+    static constexpr bool count_accesses = false;
+    static constexpr bool collect_stats = false;
 
+    double factor = 2.0;
 
-    node_type* root;
+    bool should_splay(size_t depth, size_t size)
+    {
+        size_t log_n = 0;
+        for (size_t i = size; i > 1; i >>= 1)
+            ++log_n;
 
-    Compare comp;
+        return (double)depth > factor * (double)log_n;
+    }
 };
 
-
-
-template<class Key, class T, class Compare>
-splay_tree<Key, T, Compare>::iterator::iterator(const iterator& it)
+// Full splay of every period-th access
+struct sampled_splay_policy
 {
-    this->node = it.node;
-    this->tree = it.tree;
-}
+    static constexpr bool semi = false;
+    static constexpr bool uses_depth = false;
+    static constexpr bool count_accesses = false;
+    static constexpr bool collect_stats = false;
 
-template<class Key, class T, class Compare>
-bool operator!=(const typename splay_tree<Key,T,Compare>::iterator& it1, const typename splay_tree<Key,T,Compare>::iterator& it2)
-{
-    return it1.tree != it2.tree && it1.node != it2.node;
-}
+    size_t period = 8;
+    size_t counter = 0;
 
-template<class Key, class T, class Compare>
-splay_tree<Key, T, Compare>::iterator::iterator(typename splay_tree<Key,T,Compare>::node_type* node, const splay_tree<Key, T, Compare>* tree)
-{
-    this->node = node;
-    this->tree = tree;
-}
+    bool should_splay(size_t, size_t)
+    {
+        if (++counter < period)
+            return false;
 
-// public:
-template<class Key, class T, class Compare>
-splay_tree<Key, T, Compare>::splay_tree(Compare comp)
+        counter = 0;
+        return true;
+    }
+};
+
+// Any policy that also counts accesses of every node, required by splay_tree::optimize()
+template<class BasePolicy = full_splay_policy>
+struct counting_splay_policy : BasePolicy
 {
-    root = nullptr;
-    this->comp = comp;
-}
+    static constexpr bool count_accesses = true;
+};
 
-template<class Key, class T, class Compare>
-splay_tree<Key, T, Compare>::~splay_tree()
+// Any policy that also collects statistics of the tree: rotations and the histogram of access depths
+template<class BasePolicy = full_splay_policy>
+struct stats_splay_policy : BasePolicy
 {
-    if (root == nullptr) return;
+    static constexpr bool collect_stats = true;
+};
 
-    std::queue<node_type*> q;
-    q.push(root);
 
-    do
-    {
-        auto v = q.front(); q.pop();
+// Access counter of a node, empty if the splaying policy doesn't count accesses
+template<bool>
+struct node_access_counter
+{
+    void count_access() {}
+    uint64_t accesses() const { return 0; }
+    void reset_accesses() {}
+};
 
-        if (v->l_child != nullptr)
-            q.push(v->l_child);
-        if (v->r_child != nullptr)
-            q.push(v->r_child);
+template<>
+struct node_access_counter<true>
+{
+    uint64_t access_count = 0;
 
-        delete v;
+    void count_access() { ++access_count; }
+    uint64_t accesses() const { return access_count; }
+    void reset_accesses() { access_count = 0; }
+};
 
-    } while (!q.empty());
-}
 
-// Inserts value in the splay tree
-// Returns (iterator, true) if insertion is successidied and (nullptr, false) otherwise
-// O(log(n))
-template<class Key, class T, class Compare>
-std::pair<typename splay_tree<Key, T, Compare>::iterator, bool> splay_tree<Key, T, Compare>::insert(const typename splay_tree<Key, T, Compare>::value_type& value)
+// Statistics of a splay tree returned by splay_tree::stats()
+// Counters (zig_l, zig_r, accesses, depth_histogram) stay zero unless the policy collects stats
+struct splay_tree_stats
 {
-    if (root == nullptr)
-    {
-        root = new node_type{new value_type(value), nullptr};
+    static constexpr size_t depth_buckets = 64;
 
-        return std::make_pair(iterator(root, this), true);
-    }
+    uint64_t zig_l = 0;     // left turns: a left child took the place of its parent
+    uint64_t zig_r = 0;     // right turns: a right child took the place of its parent
+    uint64_t accesses = 0;  // find, lower_bound, insert, ... of every node, existing or new
 
+    // depth_histogram[d] - number of accesses of a node at depth d (the root is at depth 0),
+    // the last bucket also counts all deeper accesses
+    std::array<uint64_t, depth_buckets> depth_histogram = {};
 
-    node_type* search = root;
+    size_t height = 0;          // number of levels, 0 for the empty tree
+    size_t node_count = 0;
+    size_t allocated_bytes = 0; // nodes and values, without allocator overhead
 
-    while (true)
+    // Returns average depth of accesses
+    double mean_depth() const
     {
-        if (value.first == search->value->first)
-        {
-            splay(search);
-
-            return std::make_pair(iterator(this), false);
-        }
-
-        if (comp(value.first, search->value->first))
-        {
-            if (search->l_child == nullptr)
-            {
-                node_type* new_v = new node_type { new value_type(value), search };
-                search->l_child = new_v;
-                splay(new_v);
+        if (accesses == 0)
+            return 0;
 
-                return std::make_pair(iterator(new_v, this), true);
-            }
-            else
-                search = search->l_child;
-        }
-        else // if (key >= root->key)
-        {
-            if (search->r_child == nullptr)
-            {
-                node_type* new_v = new node_type{ new value_type(value), search };
-                search->r_child = new_v;
-                splay(new_v);
+        double sum = 0;
+        for (size_t d = 0; d < depth_buckets; ++d)
+            sum += (double)d * (double)depth_histogram[d];
 
-                return std::make_pair(iterator(new_v, this), true);
-            }
-            else
-                search = search->r_child;
-        }
+        return sum / (double)accesses;
     }
-}
+};
 
-// Erases node with the key
-// O(log(n))
-template<class Key, class T, class Compare>
-size_t splay_tree<Key, T, Compare>::erase(const Key& key)
+// Counters of a tree, empty if the splaying policy doesn't collect stats
+template<bool>
+struct tree_stats_counter
 {
-    value_type value = extract(key);
-
-    if (value != value_type())
-        return (size_t)1;
-    else
-        return (size_t)0;
-}
+    void count_rotation(bool) {}
+    void count_access(size_t) {}
+    void fill(splay_tree_stats&) const {}
+    void reset() {}
+};
 
-// Extracts node
-// O(log(n))
-template<class Key, class T, class Compare>
-typename splay_tree<Key, T, Compare>::value_type splay_tree<Key, T, Compare>::extract(const Key & key)
+template<>
+struct tree_stats_counter<true>
 {
-    node_type* search = _find(key);
+    splay_tree_stats counters;
 
-    if (search != nullptr)
+    void count_rotation(bool left) { ++(left ? counters.zig_l : counters.zig_r); }
+    void count_access(size_t depth)
     {
-        value_type value = *search->value;
-
-        // if this key exists, then after _find it wound be in the root
-        if (root->l_child == nullptr)
-        {
-            if (root->r_child != nullptr)
-            {
-                root = search->r_child;
-                root->parent = nullptr;
-
-                delete search;
-            }
-            else
-            {
-                root = nullptr;
-
-                delete search;
-            }
-        }
-        else
-        {
-            if (root->r_child != nullptr)
-            {
-                node_type* r_root = root->r_child; // right tree
-
-                root = root->l_child; // left tree - main tree
-                root->parent = nullptr;
-
-
-                delete search; // delete old root
-
+        ++counters.accesses;
+        ++counters.depth_histogram[std::min(depth, splay_tree_stats::depth_buckets - 1)];
+    }
+    void fill(splay_tree_stats& stats) const
+    {
+        stats.zig_l = counters.zig_l;
+        stats.zig_r = counters.zig_r;
+        stats.accesses = counters.accesses;
+        stats.depth_histogram = counters.depth_histogram;
+    }
+    void reset() { counters = splay_tree_stats{}; }
+};
 
 
-                node_type* max = root;
-                while (max->r_child != nullptr)
-                {
-                    max = max->r_child;
-                }
-                splay(max);
+// Rotations and splaying shared by splay trees with parent pointers (splay_tree, splay_rope)
+// Node requirements:
+//		* Node* parent, l_child, r_child
+// rotated(y, x) is called after x took the place of its parent y, e.g. to recalculate y and then x
+//
 
-                root->r_child = r_root;
-                r_root->parent = root;
-            }
-            else
-            {
-                root = root->l_child;
-                root->parent = nullptr;
+// left turn of the node: the left child n takes the place of its parent
+// O(1)
+template<class Node, class Rotated>
+void splay_zig_l(Node* n, Node*& root, Rotated rotated)
+{
+    // x = n
+    // y = n->parent
 
-                delete search;
-            }
-        }
+    Node* y = n->parent;
+    Node* y_parent = y->parent;
 
-        return value;
+    if (y_parent != nullptr)
+    {
+        if (y_parent->l_child == y)
+            y_parent->l_child = n;
+        else // if (y_parent->r_child == y)
+            y_parent->r_child = n;
     }
     else
-        return value_type();
-}
+        root = n;
 
-// Returns iterator of node with the key
-// O(log(n))
-template<class Key, class T, class Compare>
-typename splay_tree<Key, T, Compare>::iterator splay_tree<Key, T, Compare>::find(const Key & key)
-{
-    return iterator(_find(key), this);
-}
+    y->l_child = n->r_child; // y->l_child = x->r_child
+    if (n->r_child != nullptr)
+        n->r_child->parent = y;
 
-// Returns weather splay tree is empty (true) or not (false)
-// O(1)
-template<class Key, class T, class Compare>
-bool splay_tree<Key, T, Compare>::empty() const
-{
-    return (root == nullptr);
-}
+    y->parent = n;        // y->parent = x
+    n->r_child = y;       // x->r_child = y
+    n->parent = y_parent; // x->parent = y->parent
 
-// Returns iterator to the end of the splay tree
-// O(1)
-template<class Key, class T, class Compare>
-typename splay_tree<Key, T, Compare>::iterator splay_tree<Key, T, Compare>::end() const
-{
-    return iterator(this);
+    rotated(y, n);
 }
 
-// private:
-
-// Finds node
-// O(log(n))
-template<class Key, class T, class Compare>
-typename splay_tree<Key, T, Compare>::node_type* splay_tree<Key, T, Compare>::_find(const Key & key)
+// right turn of the node: the right child n takes the place of its parent
+// O(1)
+template<class Node, class Rotated>
+void splay_zig_r(Node* n, Node*& root, Rotated rotated)
 {
-    if (root == nullptr)
-        return nullptr;
-
+    // x = n
+    // y = n->parent
 
-    node_type* search = root;
+    Node* y = n->parent;
+    Node* y_parent = y->parent;
 
-    while (true)
+    if (y_parent != nullptr)
     {
-        if (key == search->value->first)
-        {
-            splay(search);
-
-            return search;
-        }
+        if (y_parent->l_child == y)
+            y_parent->l_child = n;
+        else // if (y_parent->r_child == y)
+            y_parent->r_child = n;
+    }
+    else
+        root = n;
 
-        if (comp(key, search->value->first))
-        {
-            if(search->l_child == nullptr)
-            {
-                splay(search);
+    y->r_child = n->l_child; // y->r_child = x->l_child
+    if (n->l_child != nullptr)
+        n->l_child->parent = y;
 
-                return nullptr; // not found
-            }
-            else
-                search = search->l_child;
-        }
-        else
-        {
-            if (search->r_child == nullptr)
-            {
-                splay(search);
+    y->parent = n;        // y->parent = x
+    n->l_child = y;       // x->l_child = y
+    n->parent = y_parent; // x->parent = y->parent
 
-                return nullptr; // not found
-            }
-            else
-                search = search->r_child;
-        }
-    }
+    rotated(y, n);
 }
 
-// ascend the node to the root
-// O(log(n))
-template<class Key, class T, class Compare>
-void splay_tree<Key, T, Compare>::splay(typename splay_tree<Key, T, Compare>::node_type* n)
+// ascend the node to the root with zig, zig-zig and zig-zag steps
+// O(log(n)) amortized
+template<class Node, class Rotated>
+void splay_to_root(Node* n, Node*& root, Rotated rotated)
 {
     while (n != root)
     {
         if (n->parent->parent == nullptr)
         {
             if (n == n->parent->l_child)
-                zig_l(n);
+                splay_zig_l(n, root, rotated);
             else
-                zig_r(n);
+                splay_zig_r(n, root, rotated);
         }
         else
         {
@@ -353,96 +310,1556 @@ void splay_tree<Key, T, Compare>::splay(typename splay_tree<Key, T, Compare>::no
             {
                 if (n == n->parent->l_child)
                 {
-                    zig_l(n->parent);
-                    zig_l(n);
+                    splay_zig_l(n->parent, root, rotated);
+                    splay_zig_l(n, root, rotated);
                 }
                 else
                 {
-                    zig_r(n);
-                    zig_l(n);
+                    splay_zig_r(n, root, rotated);
+                    splay_zig_l(n, root, rotated);
                 }
             }
             else
             {
                 if (n == n->parent->r_child)
                 {
-                    zig_r(n->parent);
-                    zig_r(n);
+                    splay_zig_r(n->parent, root, rotated);
+                    splay_zig_r(n, root, rotated);
                 }
                 else
                 {
-                    zig_l(n);
-                    zig_r(n);
+                    splay_zig_l(n, root, rotated);
+                    splay_zig_r(n, root, rotated);
                 }
             }
         }
     }
 }
 
-// left turn of the node
-// O(1)
-template<class Key, class T, class Compare>
-void splay_tree<Key, T, Compare>::zig_l(typename splay_tree<Key, T, Compare>::node_type* n)
-{
-    // x = n
-    // y = n->parent
 
+template<class Key, class T, class Compare = std::less<>, class SplayPolicy = full_splay_policy>
+class splay_tree
+{
+    // index nodes and make iterators of them without descent
+    template<class, class, class, class, class>
+    friend class hashed_splay_map;
+    template<class, class, class, class>
+    friend class splay_cache;
+    // copies elements in key order without splaying
+    template<class, class, class>
+    friend class frozen_splay_tree;
+    // writes nodes in key order and builds trees of loaded nodes
+    template<class, class, class, class>
+    friend class splay_tree_dump;
+public:
+    typedef std::pair<const Key, T> value_type;
+private:
+    struct node_type : node_access_counter<SplayPolicy::count_accesses>
+    {
+        node_type(value_type* value, node_type* parent) : value(value), parent(parent) {}
 
-    if (n == nullptr || n->parent == nullptr)
-        throw std::invalid_argument("zig_l error");
-        
+        value_type* value;
 
-    node_type* y_parent = n->parent->parent;
+        node_type* parent;
+        node_type* l_child = nullptr, * r_child = nullptr;
 
-    if (n->parent->parent != nullptr)
+        size_t size = 1; // number of nodes in the subtree
+    };
+public:
+    class iterator
     {
-        if (n->parent->parent->l_child == n->parent)
-            n->parent->parent->l_child = n;
-        else // if (n->parent->parent->r_child == n->parent)
-            n->parent->parent->r_child = n;
-    }
-    else
-        root = n;
-
-    n->parent->l_child = n->r_child; // y->l_child = x->r_child
-    if (n->r_child != nullptr)
-        n->r_child->parent = n->parent;
-
-    n->parent->parent = n; // y->parent = x
-    n->r_child = n->parent; //x->r_child = y
-    n->parent = y_parent; // x->parent = y->parent
-}
+        friend class splay_tree;
+        template<class, class, class, class, class>
+        friend class hashed_splay_map;
+        template<class, class, class, class>
+        friend class splay_cache;
+        template<class, class, class, class>
+        friend class splay_tree_dump;
+    public:
+        iterator() : iterator(nullptr, nullptr) {}
+        iterator(const iterator& it) = default;
+        iterator& operator= (const iterator& it) = default;
 
-// right turn of the node
-// O(1)
-template<class Key, class T, class Compare>
-void splay_tree<Key, T, Compare>::zig_r(typename splay_tree<Key, T, Compare>::node_type* n)
-{
-    // x = n
-    // y = n->parent
+        value_type* operator-> () { return node->value; }
+        value_type& operator* () { return (*node->value); }
 
+        iterator& operator++ () { node = next_node(node); return *this; }
 
+        friend bool operator== (const iterator& it1, const iterator& it2) { return it1.node == it2.node && it1.tree == it2.tree; }
+        friend bool operator!= (const iterator& it1, const iterator& it2) { return !(it1 == it2); }
+        
+    private:
+        iterator(node_type* node, const splay_tree* tree);
+        iterator(const splay_tree* tree) : iterator(nullptr, tree) {}
+
+        node_type* node;
+        const splay_tree* tree;
+    };
+
+    // Owns a node extracted from the tree, which can be inserted back into any tree of the same type
+    // without allocation or copy of the value
+    class node_handle
+    {
+        friend class splay_tree;
+    public:
+        node_handle() : node(nullptr) {}
+        node_handle(node_handle&& other) : node(other.node) { other.node = nullptr; }
+        ~node_handle();
+
+        node_handle& operator= (node_handle&& other);
+
+        bool empty() const { return node == nullptr; }
+        explicit operator bool() const { return node != nullptr; }
+
+        const Key& key() const { return node->value->first; }
+        T& mapped() const { return node->value->second; }
+        value_type& value() const { return *node->value; }
+
+    private:
+        node_handle(node_type* node) : node(node) {}
+
+        node_type* node;
+    };
+
+    struct insert_return_type
+    {
+        iterator position;
+        bool inserted;
+        node_handle node;
+    };
+
+    // Forward-walking lookup position: seek() searches from the current element instead of the root
+    // and doesn't restructure the tree. Stays valid until its element is erased
+    class cursor
+    {
+        friend class splay_tree;
+    public:
+        value_type* operator-> () { return node->value; }
+        value_type& operator* () { return (*node->value); }
+
+        bool valid() const { return node != nullptr; }
+        void next() { node = next_node(node); }
+        bool seek(const Key& key);
+
+    private:
+        cursor(node_type* node, splay_tree* tree) : node(node), tree(tree) {}
+
+        node_type* node;
+        splay_tree* tree;
+    };
+
+    splay_tree(Compare comp = Compare{});
+    template<class InputIt>
+    splay_tree(InputIt first, InputIt last, Compare comp = Compare{});
+    splay_tree(const splay_tree&) = delete;
+    splay_tree(splay_tree&& other);
+    ~splay_tree();
+
+    splay_tree& operator= (const splay_tree&) = delete;
+    splay_tree& operator= (splay_tree&& other);
+
+    std::pair<iterator, bool> insert(const value_type& value);
+    std::pair<iterator, bool> insert(value_type&& value);
+    insert_return_type insert(node_handle&& nh);
+    template<class InputIt>
+    size_t insert_sorted(InputIt first, InputIt last);
+    template<class... Args>
+    std::pair<iterator, bool> emplace(Args&&... args);
+    template<class... Args>
+    std::pair<iterator, bool> try_emplace(const Key& key, Args&&... args);
+    template<class... Args>
+    std::pair<iterator, bool> try_emplace(Key&& key, Args&&... args);
+    template<class M>
+    std::pair<iterator, bool> insert_or_assign(const Key& key, M&& obj);
+    template<class M>
+    std::pair<iterator, bool> insert_or_assign(Key&& key, M&& obj);
+    size_t erase(const Key& key);
+    template<class K, class C = Compare, class = typename C::is_transparent>
+    size_t erase(const K& key);
+    iterator erase(iterator pos);
+    node_handle extract(const Key& key);
+    template<class K, class C = Compare, class = typename C::is_transparent>
+    node_handle extract(const K& key);
+    iterator find(const Key& key);
+    template<class K, class C = Compare, class = typename C::is_transparent>
+    iterator find(const K& key);
+    template<class InputIt, class OutputIt>
+    OutputIt find_batch(InputIt keys_first, InputIt keys_last, OutputIt out);
+    iterator lower_bound(const Key& key);
+    iterator nth(size_t k);
+    cursor make_cursor();
+
+    splay_tree split(const Key& key);
+    void join(splay_tree& right);
+    size_t erase_range(const Key& lo, const Key& hi);
+    splay_tree extract_range(const Key& lo, const Key& hi);
+
+    bool empty() const;
+    size_t size() const;
+    iterator begin() const;
+    iterator end() const;
+
+    SplayPolicy& splay_policy();
+    size_t rotations() const;
+    void reset_rotations();
+    splay_tree_stats stats() const;
+    void reset_stats();
+
+    void optimize();
+    void resume_splaying();
+    bool splaying_suspended() const;
+    void reset_accesses();
+private:
+    template<class K1, class K2>
+    int compare(const K1& a, const K2& b) const;
+
+    template<class K>
+    node_type* descend(const K& key, int& c, size_t& depth) const;
+    void link(node_type* v, node_type* parent, int c, size_t depth);
+
+    template<class V>
+    std::pair<iterator, bool> _insert_value(V&& value);
+    template<class K, class... Args>
+    std::pair<iterator, bool> _try_emplace(K&& key, Args&&... args);
+    template<class K, class M>
+    std::pair<iterator, bool> _insert_or_assign(K&& key, M&& obj);
+
+    template<class K>
+    node_type* _find(const K& key);
+    template<class K>
+    node_type* finger_search(node_type* finger, const K& key, node_type*& last) const;
+    std::pair<node_type*, bool> _insert(node_type* v);
+    template<class K>
+    node_type* _extract(const K& key);
+    template<class K>
+    size_t _erase(const K& key);
+    node_type* detach_root();
+
+    void access(node_type* n, size_t depth);
+    void access(node_type* n);
+    void splay(node_type* n);
+    void semi_splay(node_type* n);
+    void splay_max();
+
+    template<class InputIt>
+    std::vector<node_type*> make_sorted_nodes(InputIt first, InputIt last) const;
+    std::vector<node_type*> flatten() const;
+    static node_type* build(node_type* const* nodes, size_t n, node_type* parent);
+    static node_type* build_weighted(node_type* const* nodes, const uint64_t* prefix, size_t n, node_type* parent);
+
+    static node_type* next_node(node_type* n);
+    static size_t subtree_size(const node_type* n);
+    static void update_size(node_type* n);
+    static void free_node(node_type* n);
+    static void destroy(node_type* n);
+
+    void zig_l(node_type* n);
+    void zig_r(node_type* n);
+    void rotated(node_type* y, node_type* x);
+
+
+    node_type* root;
+
+    Compare comp;
+
+    SplayPolicy policy;
+    size_t rotation_count;
+    tree_stats_counter<SplayPolicy::collect_stats> stats_counter;
+
+    bool suspended; // access operations don't splay after optimize()
+};
+
+
+
+template<class Key, class T, class Compare, class SplayPolicy>
+splay_tree<Key, T, Compare, SplayPolicy>::iterator::iterator(typename splay_tree<Key, T, Compare, SplayPolicy>::node_type* node, const splay_tree<Key, T, Compare, SplayPolicy>* tree)
+{
+    this->node = node;
+    this->tree = tree;
+}
+
+template<class Key, class T, class Compare, class SplayPolicy>
+splay_tree<Key, T, Compare, SplayPolicy>::node_handle::~node_handle()
+{
+    if (node != nullptr)
+        free_node(node);
+}
+
+template<class Key, class T, class Compare, class SplayPolicy>
+typename splay_tree<Key, T, Compare, SplayPolicy>::node_handle& splay_tree<Key, T, Compare, SplayPolicy>::node_handle::operator=(node_handle&& other)
+{
+    if (this != &other)
+    {
+        if (node != nullptr)
+            free_node(node);
+
+        node = other.node;
+        other.node = nullptr;
+    }
+
+    return *this;
+}
+
+// Moves cursor to the first element with key not less than the key
+// Keys of consecutive seeks are expected to be non-decreasing, a smaller key restarts the search from the root
+// Returns whether element with exactly this key was found
+// O(log(d)) for balanced tree, where d is the distance from the current element
+template<class Key, class T, class Compare, class SplayPolicy>
+bool splay_tree<Key, T, Compare, SplayPolicy>::cursor::seek(const Key& key)
+{
+    node_type* last = nullptr;
+
+    node = tree->finger_search(node, key, last);
+
+    return node != nullptr && tree->compare(key, node->value->first) == 0;
+}
+
+// public:
+template<class Key, class T, class Compare, class SplayPolicy>
+splay_tree<Key, T, Compare, SplayPolicy>::splay_tree(Compare comp)
+{
+    root = nullptr;
+    this->comp = comp;
+
+    rotation_count = 0;
+    suspended = false;
+}
+
+// Builds balanced splay tree from the range sorted by Compare
+// Elements with repeated keys are skipped, unsorted range causes std::invalid_argument
+// O(n), no rotations
+template<class Key, class T, class Compare, class SplayPolicy>
+template<class InputIt>
+splay_tree<Key, T, Compare, SplayPolicy>::splay_tree(InputIt first, InputIt last, Compare comp) : splay_tree(comp)
+{
+    std::vector<node_type*> nodes = make_sorted_nodes(first, last);
+
+    root = build(nodes.data(), nodes.size(), nullptr);
+}
+
+template<class Key, class T, class Compare, class SplayPolicy>
+splay_tree<Key, T, Compare, SplayPolicy>::splay_tree(splay_tree&& other)
+{
+    root = other.root;
+    comp = other.comp;
+
+    policy = other.policy;
+    rotation_count = other.rotation_count;
+    stats_counter = other.stats_counter;
+    suspended = other.suspended;
+
+    other.root = nullptr;
+}
+
+template<class Key, class T, class Compare, class SplayPolicy>
+splay_tree<Key, T, Compare, SplayPolicy>::~splay_tree()
+{
+    destroy(root);
+}
+
+template<class Key, class T, class Compare, class SplayPolicy>
+splay_tree<Key, T, Compare, SplayPolicy>& splay_tree<Key, T, Compare, SplayPolicy>::operator=(splay_tree&& other)
+{
+    if (this != &other)
+    {
+        destroy(root);
+
+        root = other.root;
+        comp = other.comp;
+
+        policy = other.policy;
+        rotation_count = other.rotation_count;
+        stats_counter = other.stats_counter;
+        suspended = other.suspended;
+
+        other.root = nullptr;
+    }
+
+    return *this;
+}
+
+// Inserts value in the splay tree
+// Returns (iterator, true) if insertion is successidied and (iterator of the element with the same key, false) otherwise
+// O(log(n))
+template<class Key, class T, class Compare, class SplayPolicy>
+std::pair<typename splay_tree<Key, T, Compare, SplayPolicy>::iterator, bool> splay_tree<Key, T, Compare, SplayPolicy>::insert(const typename splay_tree<Key, T, Compare, SplayPolicy>::value_type& value)
+{
+    return _insert_value(value);
+}
+
+// Inserts value in the splay tree by moving it
+// Returns (iterator, true) if insertion is successidied and (iterator of the element with the same key, false) otherwise
+// O(log(n))
+template<class Key, class T, class Compare, class SplayPolicy>
+std::pair<typename splay_tree<Key, T, Compare, SplayPolicy>::iterator, bool> splay_tree<Key, T, Compare, SplayPolicy>::insert(typename splay_tree<Key, T, Compare, SplayPolicy>::value_type&& value)
+{
+    return _insert_value(std::move(value));
+}
+
+// Inserts node owned by the node handle without allocation or copy
+// If the key already exists, the node stays in the returned node handle
+// O(log(n))
+template<class Key, class T, class Compare, class SplayPolicy>
+typename splay_tree<Key, T, Compare, SplayPolicy>::insert_return_type splay_tree<Key, T, Compare, SplayPolicy>::insert(typename splay_tree<Key, T, Compare, SplayPolicy>::node_handle&& nh)
+{
+    if (nh.empty())
+        return insert_return_type{ end(), false, node_handle() };
+
+    auto result = _insert(nh.node);
+
+    if (result.second)
+    {
+        nh.node = nullptr;
+
+        return insert_return_type{ iterator(result.first, this), true, node_handle() };
+    }
+
+    return insert_return_type{ iterator(result.first, this), false, std::move(nh) };
+}
+
+// Constructs value in place and inserts it
+// Value is constructed before the search, use try_emplace to avoid it for an existing key
+// O(log(n))
+template<class Key, class T, class Compare, class SplayPolicy>
+template<class... Args>
+std::pair<typename splay_tree<Key, T, Compare, SplayPolicy>::iterator, bool> splay_tree<Key, T, Compare, SplayPolicy>::emplace(Args&&... args)
+{
+    node_type* v = new node_type{ new value_type(std::forward<Args>(args)...), nullptr };
+
+    auto result = _insert(v);
+
+    if (!result.second)
+        free_node(v);
+
+    return std::make_pair(iterator(result.first, this), result.second);
+}
+
+// Constructs value in place from the key and args if the key doesn't exist, args are untouched otherwise
+// O(log(n))
+template<class Key, class T, class Compare, class SplayPolicy>
+template<class... Args>
+std::pair<typename splay_tree<Key, T, Compare, SplayPolicy>::iterator, bool> splay_tree<Key, T, Compare, SplayPolicy>::try_emplace(const Key& key, Args&&... args)
+{
+    return _try_emplace(key, std::forward<Args>(args)...);
+}
+
+template<class Key, class T, class Compare, class SplayPolicy>
+template<class... Args>
+std::pair<typename splay_tree<Key, T, Compare, SplayPolicy>::iterator, bool> splay_tree<Key, T, Compare, SplayPolicy>::try_emplace(Key&& key, Args&&... args)
+{
+    return _try_emplace(std::move(key), std::forward<Args>(args)...);
+}
+
+// Inserts value if the key doesn't exist, assigns obj to the mapped value otherwise
+// Returns (iterator, true) if insertion took place and (iterator, false) if assignment
+// O(log(n))
+template<class Key, class T, class Compare, class SplayPolicy>
+template<class M>
+std::pair<typename splay_tree<Key, T, Compare, SplayPolicy>::iterator, bool> splay_tree<Key, T, Compare, SplayPolicy>::insert_or_assign(const Key& key, M&& obj)
+{
+    return _insert_or_assign(key, std::forward<M>(obj));
+}
+
+template<class Key, class T, class Compare, class SplayPolicy>
+template<class M>
+std::pair<typename splay_tree<Key, T, Compare, SplayPolicy>::iterator, bool> splay_tree<Key, T, Compare, SplayPolicy>::insert_or_assign(Key&& key, M&& obj)
+{
+    return _insert_or_assign(std::move(key), std::forward<M>(obj));
+}
+
+// Inserts elements of the range sorted by Compare
+// Elements with repeated or already existing keys are skipped, unsorted range causes std::invalid_argument
+// Returns number of inserted elements
+// Small batches are linked as leaves one by one, each search starts from the previously inserted node (finger)
+// instead of the root: O(log(d)) comparisons per element for balanced tree, where d is the distance between
+// consecutive keys, plus updates of subtree sizes up to the root. Only the last inserted node is splayed
+// Large batches are merged with the tree and the result is rebuilt as a balanced tree in O(n + m)
+template<class Key, class T, class Compare, class SplayPolicy>
+template<class InputIt>
+size_t splay_tree<Key, T, Compare, SplayPolicy>::insert_sorted(InputIt first, InputIt last)
+{
+    std::vector<node_type*> batch = make_sorted_nodes(first, last);
+
+    size_t n = size(), m = batch.size();
+
+    size_t log_n = 0;
+    for (size_t i = n; i > 1; i >>= 1)
+        ++log_n;
+
+    // an empty or single-node tree is always rebuilt: sorted insertions one by one would make a path
+    if (m * std::max(log_n, (size_t)1) <= n)
+    {
+        size_t inserted = 0;
+        node_type* finger = nullptr;
+
+        for (node_type* v : batch)
+        {
+            node_type* parent = nullptr;
+            node_type* bound = finger_search(finger, v->value->first, parent);
+
+            // bound is not less than the key, so they are equivalent unless the key is less
+            if (bound != nullptr && !comp(v->value->first, bound->value->first))
+            {
+                free_node(v);
+                finger = bound;
+
+                continue;
+            }
+
+            // the search stops under parent: on its left side if parent is the bound, on its right side otherwise
+            v->parent = parent;
+            if (bound == parent)
+                parent->l_child = v;
+            else
+                parent->r_child = v;
+
+            for (node_type* p = parent; p != nullptr; p = p->parent)
+                ++p->size;
+
+            finger = v;
+            ++inserted;
+        }
+
+        if (finger != nullptr)
+            access(finger);
+
+        return inserted;
+    }
+
+    std::vector<node_type*> nodes = flatten();
+    std::vector<node_type*> merged;
+    merged.reserve(n + m);
+
+    size_t i = 0, j = 0, inserted = 0;
+    while (i < nodes.size() || j < batch.size())
+    {
+        if (j == batch.size() || (i < nodes.size() && comp(nodes[i]->value->first, batch[j]->value->first)))
+            merged.push_back(nodes[i++]);
+        else if (i == nodes.size() || comp(batch[j]->value->first, nodes[i]->value->first))
+        {
+            merged.push_back(batch[j++]);
+            ++inserted;
+        }
+        else // the key already exists
+            free_node(batch[j++]);
+    }
+
+    root = build(merged.data(), merged.size(), nullptr);
+
+    return inserted;
+}
+
+// Erases node with the key
+// O(log(n))
+template<class Key, class T, class Compare, class SplayPolicy>
+size_t splay_tree<Key, T, Compare, SplayPolicy>::erase(const Key& key)
+{
+    return _erase(key);
+}
+
+// Erases node with the key of any type comparable with Key (Compare::is_transparent is required)
+// O(log(n))
+template<class Key, class T, class Compare, class SplayPolicy>
+template<class K, class C, class>
+size_t splay_tree<Key, T, Compare, SplayPolicy>::erase(const K& key)
+{
+    return _erase(key);
+}
+
+// Erases the element at pos (must be a valid dereferenceable iterator of this tree)
+// Returns iterator following the erased element
+// O(log(n)) amortized, doesn't compare keys
+template<class Key, class T, class Compare, class SplayPolicy>
+typename splay_tree<Key, T, Compare, SplayPolicy>::iterator splay_tree<Key, T, Compare, SplayPolicy>::erase(iterator pos)
+{
+    node_type* next = next_node(pos.node);
+
+    splay(pos.node);
+    free_node(detach_root());
+
+    return iterator(next, this);
+}
+
+// Extracts node
+// Returns node handle owning the node, empty if there is no such key
+// O(log(n))
+template<class Key, class T, class Compare, class SplayPolicy>
+typename splay_tree<Key, T, Compare, SplayPolicy>::node_handle splay_tree<Key, T, Compare, SplayPolicy>::extract(const Key & key)
+{
+    return node_handle(_extract(key));
+}
+
+// Extracts node with the key of any type comparable with Key (Compare::is_transparent is required)
+// Returns node handle owning the node, empty if there is no such key
+// O(log(n))
+template<class Key, class T, class Compare, class SplayPolicy>
+template<class K, class C, class>
+typename splay_tree<Key, T, Compare, SplayPolicy>::node_handle splay_tree<Key, T, Compare, SplayPolicy>::extract(const K& key)
+{
+    return node_handle(_extract(key));
+}
+
+// Finds every key of the range sorted by Compare and writes its iterator (or end()) to out
+// Each search starts from the previously found element (finger) instead of the root and
+// doesn't restructure the tree, only the last accessed node is splayed
+// Returns output iterator past the last written element
+// O(log(d)) per key for balanced tree, where d is the distance between consecutive keys
+template<class Key, class T, class Compare, class SplayPolicy>
+template<class InputIt, class OutputIt>
+OutputIt splay_tree<Key, T, Compare, SplayPolicy>::find_batch(InputIt keys_first, InputIt keys_last, OutputIt out)
+{
+    node_type* finger = nullptr;
+    node_type* last = nullptr;
+
+    for (; keys_first != keys_last; ++keys_first)
+    {
+        node_type* bound = finger_search(finger, *keys_first, last);
+
+        if (bound != nullptr && compare(*keys_first, bound->value->first) == 0)
+            *out = iterator(bound, this);
+        else
+            *out = end();
+
+        ++out;
+        finger = last;
+    }
+
+    if (last != nullptr)
+        access(last);
+
+    return out;
+}
+
+// Returns iterator of the first element with key not less than the key or end() if there is no such element
+// O(log(n)) amortized
+template<class Key, class T, class Compare, class SplayPolicy>
+typename splay_tree<Key, T, Compare, SplayPolicy>::iterator splay_tree<Key, T, Compare, SplayPolicy>::lower_bound(const Key& key)
+{
+    node_type* last = nullptr;
+    node_type* bound = finger_search(nullptr, key, last);
+
+    if (last != nullptr)
+        access(last);
+
+    return iterator(bound, this);
+}
+
+// Returns iterator to the element with k smaller keys (0-based position in key order) or end() if k >= size()
+// Descends by subtree sizes without comparisons
+// O(log(n)) amortized
+template<class Key, class T, class Compare, class SplayPolicy>
+typename splay_tree<Key, T, Compare, SplayPolicy>::iterator splay_tree<Key, T, Compare, SplayPolicy>::nth(size_t k)
+{
+    if (k >= size())
+        return end();
+
+    node_type* v = root;
+    size_t depth = 0;
+
+    while (k != subtree_size(v->l_child))
+    {
+        if (k < subtree_size(v->l_child))
+            v = v->l_child;
+        else
+        {
+            k -= subtree_size(v->l_child) + 1;
+            v = v->r_child;
+        }
+
+        ++depth;
+    }
+
+    access(v, depth);
+
+    return iterator(v, this);
+}
+
+// Returns cursor at the element with the smallest key
+// O(log(n))
+template<class Key, class T, class Compare, class SplayPolicy>
+typename splay_tree<Key, T, Compare, SplayPolicy>::cursor splay_tree<Key, T, Compare, SplayPolicy>::make_cursor()
+{
+    return cursor(begin().node, this);
+}
+
+// Moves all elements with keys not less than the key to the returned tree
+// O(log(n)) amortized
+template<class Key, class T, class Compare, class SplayPolicy>
+splay_tree<Key, T, Compare, SplayPolicy> splay_tree<Key, T, Compare, SplayPolicy>::split(const Key& key)
+{
+    splay_tree right(comp);
+    right.policy = policy;
+
+    if (root == nullptr)
+        return right;
+
+    int c;
+    size_t depth;
+    splay(descend(key, c, depth));
+
+    // root is now the nearest node to the key: its predecessor, its successor or the key itself
+    if (comp(root->value->first, key))
+    {
+        right.root = root->r_child;
+        root->r_child = nullptr;
+    }
+    else
+    {
+        right.root = root;
+        root = root->l_child;
+        right.root->l_child = nullptr;
+    }
+
+    if (root != nullptr)
+    {
+        root->parent = nullptr;
+        update_size(root);
+    }
+    if (right.root != nullptr)
+    {
+        right.root->parent = nullptr;
+        update_size(right.root);
+    }
+
+    return right;
+}
+
+// Appends all elements of the right tree, every key of which must be greater than any key of this tree
+// Leaves the right tree empty
+// O(log(n)) amortized
+template<class Key, class T, class Compare, class SplayPolicy>
+void splay_tree<Key, T, Compare, SplayPolicy>::join(splay_tree& right)
+{
+    if (this == &right || right.root == nullptr)
+        return;
+
+    if (root == nullptr)
+    {
+        root = right.root;
+        right.root = nullptr;
+
+        return;
+    }
+
+    splay_max();
+
+    node_type* min = right.root;
+    while (min->l_child != nullptr)
+    {
+        min = min->l_child;
+    }
+    right.splay(min);
+
+    if (!comp(root->value->first, right.root->value->first))
+        throw std::invalid_argument("join error: keys of the right tree must be greater");
+
+    root->r_child = right.root;
+    right.root->parent = root;
+    update_size(root);
+
+    right.root = nullptr;
+}
+
+// Erases all elements with keys in [lo, hi)
+// Returns number of erased elements
+// O(log(n)) amortized plus O(k) for freeing k erased nodes
+template<class Key, class T, class Compare, class SplayPolicy>
+size_t splay_tree<Key, T, Compare, SplayPolicy>::erase_range(const Key& lo, const Key& hi)
+{
+    return extract_range(lo, hi).size();
+}
+
+// Extracts all elements with keys in [lo, hi) as a separate tree
+// O(log(n)) amortized
+template<class Key, class T, class Compare, class SplayPolicy>
+splay_tree<Key, T, Compare, SplayPolicy> splay_tree<Key, T, Compare, SplayPolicy>::extract_range(const Key& lo, const Key& hi)
+{
+    if (!comp(lo, hi))
+    {
+        splay_tree empty_tree(comp);
+        empty_tree.policy = policy;
+
+        return empty_tree;
+    }
+
+    splay_tree middle = split(lo);
+    splay_tree right = middle.split(hi);
+
+    join(right);
+
+    return middle;
+}
+
+// Returns iterator of node with the key
+// O(log(n))
+template<class Key, class T, class Compare, class SplayPolicy>
+typename splay_tree<Key, T, Compare, SplayPolicy>::iterator splay_tree<Key, T, Compare, SplayPolicy>::find(const Key & key)
+{
+    return iterator(_find(key), this);
+}
+
+// Returns iterator of node with the key of any type comparable with Key (Compare::is_transparent is required)
+// O(log(n))
+template<class Key, class T, class Compare, class SplayPolicy>
+template<class K, class C, class>
+typename splay_tree<Key, T, Compare, SplayPolicy>::iterator splay_tree<Key, T, Compare, SplayPolicy>::find(const K& key)
+{
+    return iterator(_find(key), this);
+}
+
+// Returns weather splay tree is empty (true) or not (false)
+// O(1)
+template<class Key, class T, class Compare, class SplayPolicy>
+bool splay_tree<Key, T, Compare, SplayPolicy>::empty() const
+{
+    return (root == nullptr);
+}
+
+// Returns number of elements in the splay tree
+// O(1)
+template<class Key, class T, class Compare, class SplayPolicy>
+size_t splay_tree<Key, T, Compare, SplayPolicy>::size() const
+{
+    return subtree_size(root);
+}
+
+// Returns iterator to the element with the smallest key
+// O(log(n))
+template<class Key, class T, class Compare, class SplayPolicy>
+typename splay_tree<Key, T, Compare, SplayPolicy>::iterator splay_tree<Key, T, Compare, SplayPolicy>::begin() const
+{
+    node_type* min = root;
+
+    while (min != nullptr && min->l_child != nullptr)
+        min = min->l_child;
+
+    return iterator(min, this);
+}
+
+// Returns iterator to the end of the splay tree
+// O(1)
+template<class Key, class T, class Compare, class SplayPolicy>
+typename splay_tree<Key, T, Compare, SplayPolicy>::iterator splay_tree<Key, T, Compare, SplayPolicy>::end() const
+{
+    return iterator(this);
+}
+
+// Returns splaying policy object, e.g. to tune its parameters
+// O(1)
+template<class Key, class T, class Compare, class SplayPolicy>
+SplayPolicy& splay_tree<Key, T, Compare, SplayPolicy>::splay_policy()
+{
+    return policy;
+}
+
+// Returns number of rotations done since construction or the last reset_rotations()
+// O(1)
+template<class Key, class T, class Compare, class SplayPolicy>
+size_t splay_tree<Key, T, Compare, SplayPolicy>::rotations() const
+{
+    return rotation_count;
+}
+
+// Resets rotation counter
+// O(1)
+template<class Key, class T, class Compare, class SplayPolicy>
+void splay_tree<Key, T, Compare, SplayPolicy>::reset_rotations()
+{
+    rotation_count = 0;
+}
+
+// Returns statistics of the tree: counters collected since construction or the last reset_stats()
+// (if the policy collects stats, see stats_splay_policy) and the current shape of the tree
+// O(n) (height is measured by traversal)
+template<class Key, class T, class Compare, class SplayPolicy>
+splay_tree_stats splay_tree<Key, T, Compare, SplayPolicy>::stats() const
+{
+    splay_tree_stats stats;
+
+    stats_counter.fill(stats);
+
+    stats.node_count = size();
+    stats.allocated_bytes = size() * (sizeof(node_type) + sizeof(value_type));
+
+    std::vector<std::pair<const node_type*, size_t>> q; // node and its level
+
+    if (root != nullptr)
+        q.push_back(std::make_pair(root, 1));
+
+    while (!q.empty())
+    {
+        const node_type* v = q.back().first;
+        size_t level = q.back().second;
+        q.pop_back();
+
+        stats.height = std::max(stats.height, level);
+
+        if (v->l_child != nullptr)
+            q.push_back(std::make_pair(v->l_child, level + 1));
+        if (v->r_child != nullptr)
+            q.push_back(std::make_pair(v->r_child, level + 1));
+    }
+
+    return stats;
+}
+
+// Resets counters of rotations and accesses collected for stats()
+// O(1)
+template<class Key, class T, class Compare, class SplayPolicy>
+void splay_tree<Key, T, Compare, SplayPolicy>::reset_stats()
+{
+    stats_counter.reset();
+}
+
+// Rebuilds the tree into a weight-balanced search tree by access counts of nodes (Mehlhorn's bisection rule):
+// the root of every subtree splits the total weight of its keys as evenly as possible, so
+// a key accessed with frequency p gets depth O(log(1/p)), near the optimal static tree.
+// Every node weighs its access count + 1, so keys that weren't accessed still form a balanced tree.
+// Access operations (find, lower_bound, insert, ...) don't splay after the rebuild until resume_splaying(),
+// operations that restructure the tree (erase, extract, split, join) still splay
+// Requires policy with count_accesses (see counting_splay_policy)
+// O(n * log(n)), no rotations
+template<class Key, class T, class Compare, class SplayPolicy>
+void splay_tree<Key, T, Compare, SplayPolicy>::optimize()
+{
+    static_assert(SplayPolicy::count_accesses, "optimize() requires a splaying policy that counts accesses");
+
+    std::vector<node_type*> nodes = flatten();
+
+    std::vector<uint64_t> prefix(nodes.size() + 1, 0); // prefix[i] is the total weight of the first i nodes
+    for (size_t i = 0; i < nodes.size(); ++i)
+        prefix[i + 1] = prefix[i] + nodes[i]->accesses() + 1;
+
+    root = build_weighted(nodes.data(), prefix.data(), nodes.size(), nullptr);
+
+    suspended = true;
+}
+
+// Makes access operations splay again after optimize()
+// O(1)
+template<class Key, class T, class Compare, class SplayPolicy>
+void splay_tree<Key, T, Compare, SplayPolicy>::resume_splaying()
+{
+    suspended = false;
+}
+
+// Returns whether access operations don't splay since the last optimize()
+// O(1)
+template<class Key, class T, class Compare, class SplayPolicy>
+bool splay_tree<Key, T, Compare, SplayPolicy>::splaying_suspended() const
+{
+    return suspended;
+}
+
+// Resets access counters of all nodes, e.g. to start a new window before the next optimize()
+// O(n)
+template<class Key, class T, class Compare, class SplayPolicy>
+void splay_tree<Key, T, Compare, SplayPolicy>::reset_accesses()
+{
+    for (node_type* v : flatten())
+        v->reset_accesses();
+}
+
+// private:
+
+// Compares keys: returns negative if a goes before b, positive if after and 0 if they are equivalent
+// O(1)
+template<class Key, class T, class Compare, class SplayPolicy>
+template<class K1, class K2>
+int splay_tree<Key, T, Compare, SplayPolicy>::compare(const K1& a, const K2& b) const
+{
+    return three_way_compare(comp, a, b);
+}
+
+// Descends from the root to the key without restructuring the tree
+// Returns the node with the key (c == 0) or the last visited node, under which the key should be linked
+// on the side c (c < 0 - left, c > 0 - right), nullptr for the empty tree; depth is the returned node's depth
+// O(log(n)) amortized
+template<class Key, class T, class Compare, class SplayPolicy>
+template<class K>
+typename splay_tree<Key, T, Compare, SplayPolicy>::node_type* splay_tree<Key, T, Compare, SplayPolicy>::descend(const K& key, int& c, size_t& depth) const
+{
+    c = 1;
+    depth = 0;
+
+    node_type* search = root;
+
+    while (search != nullptr)
+    {
+        c = compare(key, search->value->first);
+
+        if (c == 0)
+            return search;
+
+        node_type* child = (c < 0) ? search->l_child : search->r_child;
+
+        if (child == nullptr)
+            return search;
+        else
+        {
+            search = child;
+            ++depth;
+        }
+    }
+
+    return nullptr;
+}
+
+// Links detached node as a child of the parent (at the depth) on the side c (as the root if parent is nullptr) and splays it
+// O(log(n)) amortized
+template<class Key, class T, class Compare, class SplayPolicy>
+void splay_tree<Key, T, Compare, SplayPolicy>::link(typename splay_tree<Key, T, Compare, SplayPolicy>::node_type* v, typename splay_tree<Key, T, Compare, SplayPolicy>::node_type* parent, int c, size_t depth)
+{
+    v->parent = parent;
+
+    if (parent == nullptr)
+    {
+        root = v;
+        stats_counter.count_access(0);
+
+        return;
+    }
+
+    if (c < 0)
+        parent->l_child = v;
+    else
+        parent->r_child = v;
+
+    for (node_type* p = parent; p != nullptr; p = p->parent)
+        ++p->size;
+
+    access(v, depth + 1);
+}
+
+// Inserts copy of the value or moves it in, if its key doesn't exist
+// O(log(n))
+template<class Key, class T, class Compare, class SplayPolicy>
+template<class V>
+std::pair<typename splay_tree<Key, T, Compare, SplayPolicy>::iterator, bool> splay_tree<Key, T, Compare, SplayPolicy>::_insert_value(V&& value)
+{
+    int c;
+    size_t depth;
+    node_type* search = descend(value.first, c, depth);
+
+    if (search != nullptr && c == 0)
+    {
+        access(search, depth);
+
+        return std::make_pair(iterator(search, this), false);
+    }
+
+    node_type* new_v = new node_type{ new value_type(std::forward<V>(value)), nullptr };
+    link(new_v, search, c, depth);
+
+    return std::make_pair(iterator(new_v, this), true);
+}
+
+// Constructs value from the key and args, if the key doesn't exist
+// O(log(n))
+template<class Key, class T, class Compare, class SplayPolicy>
+template<class K, class... Args>
+std::pair<typename splay_tree<Key, T, Compare, SplayPolicy>::iterator, bool> splay_tree<Key, T, Compare, SplayPolicy>::_try_emplace(K&& key, Args&&... args)
+{
+    int c;
+    size_t depth;
+    node_type* search = descend(key, c, depth);
+
+    if (search != nullptr && c == 0)
+    {
+        access(search, depth);
+
+        return std::make_pair(iterator(search, this), false);
+    }
+
+    node_type* new_v = new node_type{ new value_type(std::piecewise_construct, std::forward_as_tuple(std::forward<K>(key)), std::forward_as_tuple(std::forward<Args>(args)...)), nullptr };
+    link(new_v, search, c, depth);
+
+    return std::make_pair(iterator(new_v, this), true);
+}
+
+// Assigns obj to the mapped value of the key or inserts new value
+// O(log(n))
+template<class Key, class T, class Compare, class SplayPolicy>
+template<class K, class M>
+std::pair<typename splay_tree<Key, T, Compare, SplayPolicy>::iterator, bool> splay_tree<Key, T, Compare, SplayPolicy>::_insert_or_assign(K&& key, M&& obj)
+{
+    int c;
+    size_t depth;
+    node_type* search = descend(key, c, depth);
+
+    if (search != nullptr && c == 0)
+    {
+        search->value->second = std::forward<M>(obj);
+        access(search, depth);
+
+        return std::make_pair(iterator(search, this), false);
+    }
+
+    node_type* new_v = new node_type{ new value_type(std::forward<K>(key), std::forward<M>(obj)), nullptr };
+    link(new_v, search, c, depth);
+
+    return std::make_pair(iterator(new_v, this), true);
+}
+
+// Finds node
+// O(log(n))
+template<class Key, class T, class Compare, class SplayPolicy>
+template<class K>
+typename splay_tree<Key, T, Compare, SplayPolicy>::node_type* splay_tree<Key, T, Compare, SplayPolicy>::_find(const K& key)
+{
+    int c;
+    size_t depth;
+    node_type* search = descend(key, c, depth);
+
+    if (search == nullptr)
+        return nullptr;
+
+    access(search, depth);
+
+    return (c == 0) ? search : nullptr;
+}
+
+// Returns the first node with key not less than the key, nullptr if there is no such node
+// Climbs from the finger node (nullptr - from the root) to the lowest ancestor whose subtree holds the key and descends from it
+// Doesn't restructure the tree, last is set to the last visited node
+// O(log(d)) for balanced tree, where d is the distance from the finger
+template<class Key, class T, class Compare, class SplayPolicy>
+template<class K>
+typename splay_tree<Key, T, Compare, SplayPolicy>::node_type* splay_tree<Key, T, Compare, SplayPolicy>::finger_search(typename splay_tree<Key, T, Compare, SplayPolicy>::node_type* finger, const K& key, typename splay_tree<Key, T, Compare, SplayPolicy>::node_type*& last) const
+{
+    node_type* bound = nullptr;
+    node_type* search = root;
+
+    if (finger != nullptr && !comp(key, finger->value->first))
+    {
+        search = finger;
+
+        // subtree of a left child is bounded by its parent's key
+        while (search->parent != nullptr)
+        {
+            if (search == search->parent->l_child && comp(key, search->parent->value->first))
+            {
+                bound = search->parent;
+                break;
+            }
+
+            search = search->parent;
+        }
+    }
+
+    while (search != nullptr)
+    {
+        last = search;
+
+        int c = compare(key, search->value->first);
+
+        if (c == 0)
+            return search;
+
+        if (c < 0)
+        {
+            bound = search;
+            search = search->l_child;
+        }
+        else
+            search = search->r_child;
+    }
+
+    return bound;
+}
+
+// Links detached node into the tree and splays it
+// Returns (node, true) or (node with the same key, false) leaving the node detached
+// O(log(n))
+template<class Key, class T, class Compare, class SplayPolicy>
+std::pair<typename splay_tree<Key, T, Compare, SplayPolicy>::node_type*, bool> splay_tree<Key, T, Compare, SplayPolicy>::_insert(typename splay_tree<Key, T, Compare, SplayPolicy>::node_type* v)
+{
+    int c;
+    size_t depth;
+    node_type* search = descend(v->value->first, c, depth);
+
+    if (search != nullptr && c == 0)
+    {
+        access(search, depth);
+
+        return std::make_pair(search, false);
+    }
+
+    link(v, search, c, depth);
+
+    return std::make_pair(v, true);
+}
+
+// Unlinks node with the key from the tree
+// Returns the unlinked node or nullptr if there is no such key
+// O(log(n))
+template<class Key, class T, class Compare, class SplayPolicy>
+template<class K>
+typename splay_tree<Key, T, Compare, SplayPolicy>::node_type* splay_tree<Key, T, Compare, SplayPolicy>::_extract(const K& key)
+{
+    int c;
+    size_t depth;
+    node_type* search = descend(key, c, depth);
+
+    if (search == nullptr)
+        return nullptr;
+
+    splay(search);
+
+    if (c != 0)
+        return nullptr;
+
+    return detach_root();
+}
+
+// Erases node with the key
+// Returns number of erased nodes (0 or 1)
+// O(log(n))
+template<class Key, class T, class Compare, class SplayPolicy>
+template<class K>
+size_t splay_tree<Key, T, Compare, SplayPolicy>::_erase(const K& key)
+{
+    node_type* search = _extract(key);
+
+    if (search == nullptr)
+        return (size_t)0;
+
+    free_node(search);
+
+    return (size_t)1;
+}
+
+// Unlinks the root and joins its subtrees
+// Returns the unlinked node
+// O(log(n)) amortized
+template<class Key, class T, class Compare, class SplayPolicy>
+typename splay_tree<Key, T, Compare, SplayPolicy>::node_type* splay_tree<Key, T, Compare, SplayPolicy>::detach_root()
+{
+    node_type* search = root;
+    node_type* l_root = search->l_child;
+    node_type* r_root = search->r_child;
+
+    if (l_root == nullptr)
+    {
+        root = r_root;
+        if (root != nullptr)
+            root->parent = nullptr;
+    }
+    else
+    {
+        root = l_root; // left tree - main tree
+        root->parent = nullptr;
+
+        if (r_root != nullptr)
+        {
+            splay_max();
+
+            root->r_child = r_root;
+            r_root->parent = root;
+            update_size(root);
+        }
+    }
+
+    search->parent = search->l_child = search->r_child = nullptr;
+    search->size = 1;
+
+    return search;
+}
+
+// Splays accessed node at the depth as the splaying policy decides
+// O(log(n)) amortized for full splay
+template<class Key, class T, class Compare, class SplayPolicy>
+void splay_tree<Key, T, Compare, SplayPolicy>::access(typename splay_tree<Key, T, Compare, SplayPolicy>::node_type* n, size_t depth)
+{
+    n->count_access();
+    stats_counter.count_access(depth);
+
+    if (suspended || !policy.should_splay(depth, size()))
+        return;
+
+    if (SplayPolicy::semi)
+        semi_splay(n);
+    else
+        splay(n);
+}
+
+// Splays accessed node as the splaying policy decides, the depth is counted only if the policy uses it or collects stats
+// O(log(n)) amortized for full splay
+template<class Key, class T, class Compare, class SplayPolicy>
+void splay_tree<Key, T, Compare, SplayPolicy>::access(typename splay_tree<Key, T, Compare, SplayPolicy>::node_type* n)
+{
+    size_t depth = 0;
+
+    if (SplayPolicy::uses_depth || SplayPolicy::collect_stats)
+    {
+        for (node_type* p = n->parent; p != nullptr; p = p->parent)
+            ++depth;
+    }
+
+    access(n, depth);
+}
+
+// ascend the node to the root
+// O(log(n))
+template<class Key, class T, class Compare, class SplayPolicy>
+void splay_tree<Key, T, Compare, SplayPolicy>::splay(typename splay_tree<Key, T, Compare, SplayPolicy>::node_type* n)
+{
+    splay_to_root(n, root, [this](node_type* y, node_type* x) { rotated(y, x); });
+}
+
+// ascend the node about halfway to the root: zig-zig steps rotate only the parent
+// and continue from it, zig-zag steps are the same as in splay, stops under the root
+// O(log(n)) amortized
+template<class Key, class T, class Compare, class SplayPolicy>
+void splay_tree<Key, T, Compare, SplayPolicy>::semi_splay(typename splay_tree<Key, T, Compare, SplayPolicy>::node_type* n)
+{
+    while (n != root && n->parent != root)
+    {
+        if (n->parent == n->parent->parent->l_child)
+        {
+            if (n == n->parent->l_child)
+            {
+                n = n->parent;
+                zig_l(n);
+            }
+            else
+            {
+                zig_r(n);
+                zig_l(n);
+            }
+        }
+        else
+        {
+            if (n == n->parent->r_child)
+            {
+                n = n->parent;
+                zig_r(n);
+            }
+            else
+            {
+                zig_l(n);
+                zig_r(n);
+            }
+        }
+    }
+}
+
+// ascend the node with the greatest key to the root
+// O(log(n))
+template<class Key, class T, class Compare, class SplayPolicy>
+void splay_tree<Key, T, Compare, SplayPolicy>::splay_max()
+{
+    if (root == nullptr)
+        return;
+
+    node_type* max = root;
+    while (max->r_child != nullptr)
+    {
+        max = max->r_child;
+    }
+    splay(max);
+}
+
+// left turn of the node
+// O(1)
+template<class Key, class T, class Compare, class SplayPolicy>
+void splay_tree<Key, T, Compare, SplayPolicy>::zig_l(typename splay_tree<Key, T, Compare, SplayPolicy>::node_type* n)
+{
+    if (n == nullptr || n->parent == nullptr)
+        throw std::invalid_argument("zig_l error");
+
+    splay_zig_l(n, root, [this](node_type* y, node_type* x) { rotated(y, x); });
+}
+
+// right turn of the node
+// O(1)
+template<class Key, class T, class Compare, class SplayPolicy>
+void splay_tree<Key, T, Compare, SplayPolicy>::zig_r(typename splay_tree<Key, T, Compare, SplayPolicy>::node_type* n)
+{
     if (n == nullptr || n->parent == nullptr)
         throw std::invalid_argument("zig_r error");
 
-    node_type* y_parent = n->parent->parent;
+    splay_zig_r(n, root, [this](node_type* y, node_type* x) { rotated(y, x); });
+}
+
+// Counts the rotation and recalculates sizes of the old parent y and the node x which took its place
+// O(1)
+template<class Key, class T, class Compare, class SplayPolicy>
+void splay_tree<Key, T, Compare, SplayPolicy>::rotated(typename splay_tree<Key, T, Compare, SplayPolicy>::node_type* y, typename splay_tree<Key, T, Compare, SplayPolicy>::node_type* x)
+{
+    ++rotation_count;
+    stats_counter.count_rotation(x->r_child == y); // zig_l leaves the old parent on the right
+
+    update_size(y);
+    update_size(x);
+}
+
+// Allocates detached nodes for the range sorted by Compare, skipping repeated keys
+// O(n)
+template<class Key, class T, class Compare, class SplayPolicy>
+template<class InputIt>
+std::vector<typename splay_tree<Key, T, Compare, SplayPolicy>::node_type*> splay_tree<Key, T, Compare, SplayPolicy>::make_sorted_nodes(InputIt first, InputIt last) const
+{
+    std::vector<node_type*> nodes;
+
+    for (; first != last; ++first)
+    {
+        node_type* v = new node_type{ new value_type(*first), nullptr };
+
+        if (!nodes.empty() && !comp(nodes.back()->value->first, v->value->first))
+        {
+            bool repeated = !comp(v->value->first, nodes.back()->value->first);
+
+            free_node(v);
+
+            if (repeated)
+                continue;
+
+            for (node_type* x : nodes)
+                free_node(x);
+            throw std::invalid_argument("range is not sorted");
+        }
+
+        nodes.push_back(v);
+    }
+
+    return nodes;
+}
+
+// Returns all nodes in key order
+// O(n)
+template<class Key, class T, class Compare, class SplayPolicy>
+std::vector<typename splay_tree<Key, T, Compare, SplayPolicy>::node_type*> splay_tree<Key, T, Compare, SplayPolicy>::flatten() const
+{
+    std::vector<node_type*> nodes;
+    nodes.reserve(size());
+
+    std::vector<node_type*> path;
+    node_type* v = root;
 
-    if (n->parent->parent != nullptr)
+    while (v != nullptr || !path.empty())
     {
-        if (n->parent->parent->l_child == n->parent)
-            n->parent->parent->l_child = n;
-        else // if (n->parent->parent->r_child == n->parent)
-            n->parent->parent->r_child = n;
+        for (; v != nullptr; v = v->l_child)
+            path.push_back(v);
+
+        v = path.back(); path.pop_back();
+        nodes.push_back(v);
+
+        v = v->r_child;
     }
-    else
-        root = n;
 
-    n->parent->r_child = n->l_child; // y->r_child = x->l_child
-    if (n->l_child != nullptr)
-        n->l_child->parent = n->parent;
+    return nodes;
+}
 
-    n->parent->parent = n; // y->parent = x
-    n->l_child = n->parent; //x->l_child = y
-    n->parent = y_parent; // x->parent = y->parent
+// Links sorted nodes into a balanced subtree and returns its root
+// O(n)
+template<class Key, class T, class Compare, class SplayPolicy>
+typename splay_tree<Key, T, Compare, SplayPolicy>::node_type* splay_tree<Key, T, Compare, SplayPolicy>::build(typename splay_tree<Key, T, Compare, SplayPolicy>::node_type* const* nodes, size_t n, typename splay_tree<Key, T, Compare, SplayPolicy>::node_type* parent)
+{
+    if (n == 0)
+        return nullptr;
+
+    size_t mid = n / 2;
+    node_type* v = nodes[mid];
+
+    v->parent = parent;
+    v->l_child = build(nodes, mid, v);
+    v->r_child = build(nodes + mid + 1, n - mid - 1, v);
+    v->size = n;
+
+    return v;
+}
+
+// Links n nodes sorted by key into a weight-balanced tree, prefix[i] - prefix[0] is the total weight of the first i nodes
+// The root is the node closest to the weighted median
+// O(n * log(n))
+template<class Key, class T, class Compare, class SplayPolicy>
+typename splay_tree<Key, T, Compare, SplayPolicy>::node_type* splay_tree<Key, T, Compare, SplayPolicy>::build_weighted(typename splay_tree<Key, T, Compare, SplayPolicy>::node_type* const* nodes, const uint64_t* prefix, size_t n, typename splay_tree<Key, T, Compare, SplayPolicy>::node_type* parent)
+{
+    if (n == 0)
+        return nullptr;
+
+    // the first node whose weight reaches the middle of the total weight
+    uint64_t middle = prefix[0] + (prefix[n] - prefix[0]) / 2;
+    size_t mid = std::upper_bound(prefix + 1, prefix + n + 1, middle) - (prefix + 1);
+    if (mid == n)
+        mid = n - 1;
+
+    node_type* v = nodes[mid];
+
+    v->parent = parent;
+    v->l_child = build_weighted(nodes, prefix, mid, v);
+    v->r_child = build_weighted(nodes + mid + 1, prefix + mid + 1, n - mid - 1, v);
+    v->size = n;
+
+    return v;
+}
+
+// Returns the next node in key order, nullptr for the last one
+// O(1) amortized
+template<class Key, class T, class Compare, class SplayPolicy>
+typename splay_tree<Key, T, Compare, SplayPolicy>::node_type* splay_tree<Key, T, Compare, SplayPolicy>::next_node(typename splay_tree<Key, T, Compare, SplayPolicy>::node_type* n)
+{
+    if (n->r_child != nullptr)
+    {
+        n = n->r_child;
+        while (n->l_child != nullptr)
+            n = n->l_child;
+
+        return n;
+    }
+
+    while (n->parent != nullptr && n == n->parent->r_child)
+        n = n->parent;
+
+    return n->parent;
+}
+
+// Returns number of nodes in the subtree (0 for nullptr)
+// O(1)
+template<class Key, class T, class Compare, class SplayPolicy>
+size_t splay_tree<Key, T, Compare, SplayPolicy>::subtree_size(const typename splay_tree<Key, T, Compare, SplayPolicy>::node_type* n)
+{
+    return (n != nullptr) ? n->size : 0;
+}
+
+// Recalculates size of the node from its children
+// O(1)
+template<class Key, class T, class Compare, class SplayPolicy>
+void splay_tree<Key, T, Compare, SplayPolicy>::update_size(typename splay_tree<Key, T, Compare, SplayPolicy>::node_type* n)
+{
+    n->size = 1 + subtree_size(n->l_child) + subtree_size(n->r_child);
+}
+
+// Frees the node together with its value
+// O(1)
+template<class Key, class T, class Compare, class SplayPolicy>
+void splay_tree<Key, T, Compare, SplayPolicy>::free_node(typename splay_tree<Key, T, Compare, SplayPolicy>::node_type* n)
+{
+    delete n->value;
+    delete n;
 }
 
+// Frees all nodes of the subtree together with their values
+// O(n)
+template<class Key, class T, class Compare, class SplayPolicy>
+void splay_tree<Key, T, Compare, SplayPolicy>::destroy(typename splay_tree<Key, T, Compare, SplayPolicy>::node_type* n)
+{
+    if (n == nullptr) return;
+
+    std::queue<node_type*> q;
+    q.push(n);
+
+    do
+    {
+        auto v = q.front(); q.pop();
+
+        if (v->l_child != nullptr)
+            q.push(v->l_child);
+        if (v->r_child != nullptr)
+            q.push(v->r_child);
+
+        free_node(v);
+
+    } while (!q.empty());
+}
\ No newline at end of file
@@ -0,0 +1,307 @@
+//
+// "splay_tree_dump.h" is a library with binary dump and load of splay tree
+//
+
+#pragma once
+
+#include "splay_tree.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <istream>
+#include <ostream>
+#include <fstream>
+#include <stdexcept>
+#include <type_traits>
+
+#if __has_include(<sys/mman.h>) && __has_include(<sys/stat.h>) && __has_include(<fcntl.h>) && __has_include(<unistd.h>)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define SPLAY_TREE_DUMP_MMAP 1
+#endif
+
+
+// Splay tree dump format
+//
+// A header followed by count records in key order, every record is sizeof(Key) bytes of the key
+// and sizeof(T) bytes of the mapped value without padding. Integers are in the byte order of the
+// machine that wrote the dump, the header stores a byte order mark to reject foreign dumps.
+// Key and T must be trivially copyable (and default constructible to be loaded).
+//
+// A dump is loaded by an O(n) balanced build: no comparisons and no rotations, so the keys
+// must be sorted by the same Compare as in the tree that wrote it
+//
+
+struct splay_tree_dump_header
+{
+    static constexpr uint32_t current_version = 1;
+    static constexpr uint32_t byte_order_mark = 0x01020304;
+
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t key_size;
+    uint32_t mapped_size;
+    uint64_t count;
+};
+
+static_assert(sizeof(splay_tree_dump_header) == 32, "splay_tree_dump_header must have no padding");
+
+
+// Splay tree dump structure
+//
+// Static functions writing splay_tree<Key, T, Compare, SplayPolicy> to a dump and building it from a dump
+//
+
+template<class Key, class T, class Compare = std::less<>, class SplayPolicy = full_splay_policy>
+class splay_tree_dump
+{
+public:
+    typedef splay_tree<Key, T, Compare, SplayPolicy> tree_type;
+
+    splay_tree_dump() = delete;
+
+    static void dump(const tree_type& tree, std::ostream& out, size_t buffer_size = 1 << 16);
+    static void dump(const tree_type& tree, const std::string& path, size_t buffer_size = 1 << 20);
+    static tree_type load(std::istream& in, Compare comp = Compare{}, size_t buffer_size = 1 << 20);
+    static tree_type load(const std::string& path, Compare comp = Compare{});
+private:
+    typedef typename tree_type::node_type node_type;
+    typedef typename tree_type::value_type value_type;
+
+    static void check_header(const splay_tree_dump_header& header);
+    static node_type* make_node(const char* record);
+};
+
+
+// Writes all elements in key order to the stream as a binary dump (see splay tree dump format above)
+// Elements are copied to a buffer of buffer_size bytes (at least one record), nothing else is allocated,
+// so a tree of any size is written in bounded memory
+// Throws std::runtime_error if writing fails
+// O(n), doesn't splay
+template<class Key, class T, class Compare, class SplayPolicy>
+void splay_tree_dump<Key, T, Compare, SplayPolicy>::dump(const tree_type& tree, std::ostream& out, size_t buffer_size)
+{
+    static_assert(std::is_trivially_copyable<Key>::value && std::is_trivially_copyable<T>::value, "dump() requires trivially copyable Key and T");
+
+    const size_t record_size = sizeof(Key) + sizeof(T);
+
+    splay_tree_dump_header header;
+    std::memcpy(header.magic, "SPLAYTRE", sizeof(header.magic));
+    header.version = splay_tree_dump_header::current_version;
+    header.byte_order = splay_tree_dump_header::byte_order_mark;
+    header.key_size = sizeof(Key);
+    header.mapped_size = sizeof(T);
+    header.count = tree.size();
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    std::vector<char> buffer(std::max(buffer_size / record_size, (size_t)1) * record_size);
+    size_t used = 0;
+
+    for (node_type* v = tree.begin().node; v != nullptr && out; v = tree_type::next_node(v))
+    {
+        if (used == buffer.size())
+        {
+            out.write(buffer.data(), used);
+            used = 0;
+        }
+
+        std::memcpy(buffer.data() + used, &v->value->first, sizeof(Key));
+        std::memcpy(buffer.data() + used + sizeof(Key), &v->value->second, sizeof(T));
+        used += record_size;
+    }
+
+    out.write(buffer.data(), used);
+
+    if (!out)
+        throw std::runtime_error("splay_tree_dump::dump failed to write the stream");
+}
+
+// Writes binary dump to the file, replacing its content
+// Throws std::runtime_error if the file can't be written
+// O(n), doesn't splay
+template<class Key, class T, class Compare, class SplayPolicy>
+void splay_tree_dump<Key, T, Compare, SplayPolicy>::dump(const tree_type& tree, const std::string& path, size_t buffer_size)
+{
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+
+    if (!out)
+        throw std::runtime_error("splay_tree_dump::dump can't open " + path);
+
+    dump(tree, out, buffer_size);
+
+    out.close();
+
+    if (!out)
+        throw std::runtime_error("splay_tree_dump::dump failed to write " + path);
+}
+
+// Builds balanced tree from binary dump read from the stream by chunks of buffer_size bytes
+// Throws std::runtime_error if the dump is damaged, truncated or written for other Key or T
+// O(n), no comparisons and no rotations
+template<class Key, class T, class Compare, class SplayPolicy>
+typename splay_tree_dump<Key, T, Compare, SplayPolicy>::tree_type splay_tree_dump<Key, T, Compare, SplayPolicy>::load(std::istream& in, Compare comp, size_t buffer_size)
+{
+    static_assert(std::is_trivially_copyable<Key>::value && std::is_trivially_copyable<T>::value, "load() requires trivially copyable Key and T");
+
+    const size_t record_size = sizeof(Key) + sizeof(T);
+
+    splay_tree_dump_header header;
+
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)))
+        throw std::runtime_error("splay_tree_dump::load: not a splay_tree dump");
+
+    check_header(header);
+
+    std::vector<node_type*> nodes;
+    std::vector<char> buffer(std::max(buffer_size / record_size, (size_t)1) * record_size);
+
+    try
+    {
+        while (nodes.size() < header.count)
+        {
+            size_t records = std::min((uint64_t)(buffer.size() / record_size), header.count - nodes.size());
+
+            if (!in.read(buffer.data(), records * record_size))
+                throw std::runtime_error("splay_tree_dump::load: the dump is truncated");
+
+            for (size_t i = 0; i < records; ++i)
+                nodes.push_back(make_node(buffer.data() + i * record_size));
+        }
+    }
+    catch (...)
+    {
+        for (node_type* v : nodes)
+            tree_type::free_node(v);
+
+        throw;
+    }
+
+    tree_type tree(comp);
+    tree.root = tree_type::build(nodes.data(), nodes.size(), nullptr);
+
+    return tree;
+}
+
+// Builds balanced tree from binary dump file, which is memory-mapped where POSIX mmap is available
+// and read as a stream otherwise
+// Throws std::runtime_error if the file can't be read or the dump is damaged, truncated or written for other Key or T
+// O(n), no comparisons and no rotations
+template<class Key, class T, class Compare, class SplayPolicy>
+typename splay_tree_dump<Key, T, Compare, SplayPolicy>::tree_type splay_tree_dump<Key, T, Compare, SplayPolicy>::load(const std::string& path, Compare comp)
+{
+#ifdef SPLAY_TREE_DUMP_MMAP
+    static_assert(std::is_trivially_copyable<Key>::value && std::is_trivially_copyable<T>::value, "load() requires trivially copyable Key and T");
+
+    const size_t record_size = sizeof(Key) + sizeof(T);
+
+    int fd = ::open(path.c_str(), O_RDONLY);
+
+    if (fd < 0)
+        throw std::runtime_error("splay_tree_dump::load can't open " + path);
+
+    struct stat st;
+
+    if (::fstat(fd, &st) != 0)
+    {
+        ::close(fd);
+        throw std::runtime_error("splay_tree_dump::load can't read " + path);
+    }
+
+    const size_t bytes = (size_t)st.st_size;
+
+    if (bytes < sizeof(splay_tree_dump_header))
+    {
+        ::close(fd);
+        throw std::runtime_error("splay_tree_dump::load: not a splay_tree dump");
+    }
+
+    void* data = ::mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+
+    if (data == MAP_FAILED)
+        throw std::runtime_error("splay_tree_dump::load can't map " + path);
+
+    ::madvise(data, bytes, MADV_SEQUENTIAL);
+
+    const char* records = static_cast<const char*>(data) + sizeof(splay_tree_dump_header);
+    std::vector<node_type*> nodes;
+
+    try
+    {
+        splay_tree_dump_header header;
+        std::memcpy(&header, data, sizeof(header));
+
+        check_header(header);
+
+        if ((bytes - sizeof(header)) / record_size != header.count || (bytes - sizeof(header)) % record_size != 0)
+            throw std::runtime_error("splay_tree_dump::load: the dump is truncated");
+
+        nodes.reserve(header.count);
+
+        for (uint64_t i = 0; i < header.count; ++i)
+            nodes.push_back(make_node(records + i * record_size));
+    }
+    catch (...)
+    {
+        for (node_type* v : nodes)
+            tree_type::free_node(v);
+
+        ::munmap(data, bytes);
+
+        throw;
+    }
+
+    ::munmap(data, bytes);
+
+    tree_type tree(comp);
+    tree.root = tree_type::build(nodes.data(), nodes.size(), nullptr);
+
+    return tree;
+#else
+    std::ifstream in(path, std::ios::binary);
+
+    if (!in)
+        throw std::runtime_error("splay_tree_dump::load can't open " + path);
+
+    return load(in, comp);
+#endif
+}
+
+// Throws std::runtime_error if the header is not of a dump of this format version, byte order, Key and T
+// O(1)
+template<class Key, class T, class Compare, class SplayPolicy>
+void splay_tree_dump<Key, T, Compare, SplayPolicy>::check_header(const splay_tree_dump_header& header)
+{
+    if (std::memcmp(header.magic, "SPLAYTRE", sizeof(header.magic)) != 0)
+        throw std::runtime_error("splay_tree_dump::load: not a splay_tree dump");
+
+    if (header.version != splay_tree_dump_header::current_version)
+        throw std::runtime_error("splay_tree_dump::load: unsupported dump version");
+
+    if (header.byte_order != splay_tree_dump_header::byte_order_mark)
+        throw std::runtime_error("splay_tree_dump::load: the dump has other byte order");
+
+    if (header.key_size != sizeof(Key) || header.mapped_size != sizeof(T))
+        throw std::runtime_error("splay_tree_dump::load: the dump has other Key or T size");
+}
+
+// Allocates detached node with the key and the mapped value copied from the record
+// O(1)
+template<class Key, class T, class Compare, class SplayPolicy>
+typename splay_tree_dump<Key, T, Compare, SplayPolicy>::node_type* splay_tree_dump<Key, T, Compare, SplayPolicy>::make_node(const char* record)
+{
+    Key key;
+    T mapped;
+
+    std::memcpy(&key, record, sizeof(Key));
+    std::memcpy(&mapped, record + sizeof(Key), sizeof(T));
+
+    return new node_type{ new value_type(key, mapped), nullptr };
+}
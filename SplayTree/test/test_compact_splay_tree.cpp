@@ -0,0 +1,126 @@
+#include "compact_splay_tree.h"
+#include <gtest/gtest.h>
+
+#include <map>
+#include <cstdint>
+#include <ctime>
+#include <cstdlib>
+
+
+TEST(CompactSplayTreeRandomInsertEraseFind, StdMap)
+{
+    compact_splay_tree<int32_t, int32_t> test_tree;
+    std::map<int32_t, int32_t> std_tree;
+
+    srand(time(NULL));
+
+    const size_t N = 5000;
+
+    for (size_t i = 0; i < N; ++i)
+    {
+        int32_t key = rand() % 500;
+
+        switch (rand() % 3)
+        {
+        case 0:
+        {
+            std::pair<const int32_t, int32_t> value = std::make_pair(key, rand());
+
+            EXPECT_EQ(test_tree.insert(value).second, std_tree.insert(value).second);
+            break;
+        }
+        case 1:
+            EXPECT_EQ(test_tree.erase(key), std_tree.erase(key));
+            break;
+        case 2:
+        {
+            auto it = test_tree.find(key);
+            auto std_it = std_tree.find(key);
+
+            if (std_it == std_tree.end())
+                EXPECT_TRUE(it == test_tree.end());
+            else
+            {
+                ASSERT_TRUE(it != test_tree.end());
+                EXPECT_EQ((*it).second, std_it->second);
+            }
+            break;
+        }
+        }
+
+        EXPECT_EQ(test_tree.size(), std_tree.size());
+    }
+
+    auto std_it = std_tree.begin();
+    for (auto it = test_tree.begin(); it != test_tree.end(); ++it, ++std_it)
+    {
+        ASSERT_TRUE(std_it != std_tree.end());
+        EXPECT_EQ((*it).first, std_it->first);
+        EXPECT_EQ((*it).second, std_it->second);
+    }
+    EXPECT_TRUE(std_it == std_tree.end());
+}
+
+TEST(CompactSplayTreeRelayout, StdMap)
+{
+    compact_splay_tree<int32_t, int32_t> test_tree;
+    std::map<int32_t, int32_t> std_tree;
+
+    srand(time(NULL));
+
+    const size_t N = 2000;
+
+    for (size_t i = 0; i < N; ++i)
+    {
+        int32_t key = rand() % 1000;
+
+        if (rand() % 4 != 0)
+        {
+            test_tree.insert(std::make_pair(key, key));
+            std_tree.insert(std::make_pair(key, key));
+        }
+        else
+        {
+            test_tree.erase(key);
+            std_tree.erase(key);
+        }
+
+        if (i % 500 == 0)
+            test_tree.relayout(layout_order::in_order);
+        if (i % 500 == 250)
+            test_tree.relayout(layout_order::van_emde_boas);
+    }
+
+    test_tree.relayout();
+
+    ASSERT_EQ(test_tree.size(), std_tree.size());
+
+    for (int32_t key = -1; key <= 1000; ++key)
+    {
+        auto it = test_tree.lower_bound(key);
+        auto std_it = std_tree.lower_bound(key);
+
+        if (std_it == std_tree.end())
+            EXPECT_TRUE(it == test_tree.end());
+        else
+        {
+            ASSERT_TRUE(it != test_tree.end());
+            EXPECT_EQ((*it).first, std_it->first);
+        }
+    }
+
+    test_tree.relayout(layout_order::in_order);
+
+    auto std_it = std_tree.begin();
+    for (auto it = test_tree.begin(); it != test_tree.end(); ++it, ++std_it)
+    {
+        ASSERT_TRUE(std_it != std_tree.end());
+        EXPECT_EQ((*it).first, std_it->first);
+    }
+    EXPECT_TRUE(std_it == std_tree.end());
+
+    compact_splay_tree<int32_t, int32_t> empty_tree;
+    empty_tree.relayout();
+    EXPECT_TRUE(empty_tree.empty());
+    EXPECT_TRUE(empty_tree.begin() == empty_tree.end());
+}
@@ -0,0 +1,147 @@
+#include "concurrent_splay_map.h"
+#include <gtest/gtest.h>
+
+#include <map>
+#include <vector>
+#include <thread>
+#include <cstdint>
+#include <ctime>
+#include <cstdlib>
+
+
+TEST(ConcurrentSplayMapRandomInsertEraseFind, StdMap)
+{
+    concurrent_splay_map<int32_t, int32_t> test_map({ 250, 500, 750 });
+    std::map<int32_t, int32_t> std_map;
+
+    srand(time(NULL));
+
+    const size_t N = 5000;
+
+    for (size_t i = 0; i < N; ++i)
+    {
+        int32_t key = rand() % 1000;
+
+        switch (rand() % 3)
+        {
+        case 0:
+        {
+            std::pair<const int32_t, int32_t> value = std::make_pair(key, rand());
+
+            EXPECT_EQ(test_map.insert(value), std_map.insert(value).second);
+            break;
+        }
+        case 1:
+            EXPECT_EQ(test_map.erase(key), std_map.erase(key));
+            break;
+        case 2:
+        {
+            int32_t value = 0;
+            auto std_it = std_map.find(key);
+
+            EXPECT_EQ(test_map.find(key, value), std_it != std_map.end());
+            if (std_it != std_map.end())
+            {
+                EXPECT_EQ(value, std_it->second);
+            }
+            break;
+        }
+        }
+
+        if (i % 1000 == 0)
+            test_map.rebalance();
+    }
+
+    EXPECT_EQ(test_map.size(), std_map.size());
+
+    for (size_t i = 0; i < 50; ++i)
+    {
+        int32_t lo = rand() % 1100 - 50;
+        int32_t hi = lo + rand() % 400;
+
+        std::vector<int32_t> keys;
+        test_map.for_each_range(lo, hi, [&keys](const std::pair<const int32_t, int32_t>& x) { keys.push_back(x.first); });
+
+        std::vector<int32_t> std_keys;
+        for (auto it = std_map.lower_bound(lo); it != std_map.end() && it->first < hi; ++it)
+            std_keys.push_back(it->first);
+
+        EXPECT_EQ(keys, std_keys);
+    }
+}
+
+TEST(ConcurrentSplayMapRebalance, HotRange)
+{
+    concurrent_splay_map<int32_t, int32_t> test_map({ 1000, 2000, 3000 });
+
+    for (int32_t key = 0; key < 4000; ++key)
+        test_map.insert(std::make_pair(key, key));
+
+    test_map.rebalance(); // forget the inserts
+
+    // all operations go to the first shard
+    for (int32_t i = 0; i < 10000; ++i)
+        test_map.contains(i % 1000);
+
+    // [0, 1000) is split at 500, cold [1000, 4000) is merged into one shard
+    EXPECT_EQ(test_map.rebalance(), (size_t)3);
+    EXPECT_EQ(test_map.size(), (size_t)4000);
+
+    for (int32_t i = 0; i < 10000; ++i)
+        test_map.contains(i % 250);
+
+    // [0, 500) is split at 250, cold [500, 1000) and [1000, 4000) are merged
+    EXPECT_EQ(test_map.rebalance(), (size_t)3);
+    EXPECT_EQ(test_map.size(), (size_t)4000);
+
+    int32_t expected = 0;
+    test_map.for_each_range(0, 4000, [&expected](const std::pair<const int32_t, int32_t>& x) { EXPECT_EQ(x.first, expected++); });
+    EXPECT_EQ(expected, 4000);
+
+    EXPECT_THROW((concurrent_splay_map<int32_t, int32_t>({ 2, 1 })), std::invalid_argument);
+}
+
+TEST(ConcurrentSplayMapThreads, DisjointWriters)
+{
+    concurrent_splay_map<int32_t, int32_t> test_map({ 10000, 20000, 30000 });
+
+    const int32_t N = 10000;
+
+    std::vector<std::thread> writers;
+    for (int32_t t = 0; t < 4; ++t)
+        writers.emplace_back([&test_map, t, N]()
+        {
+            for (int32_t key = t * N; key < (t + 1) * N; ++key)
+                test_map.insert(std::make_pair(key, -key));
+
+            // erase odd keys
+            for (int32_t key = t * N + 1; key < (t + 1) * N; key += 2)
+                test_map.erase(key);
+        });
+
+    std::thread rebalancer([&test_map]()
+    {
+        for (int i = 0; i < 50; ++i)
+        {
+            test_map.rebalance();
+            std::this_thread::yield();
+        }
+    });
+
+    for (auto& t : writers)
+        t.join();
+    rebalancer.join();
+
+    EXPECT_EQ(test_map.size(), (size_t)(2 * N));
+
+    for (int32_t key = 0; key < 4 * N; ++key)
+    {
+        int32_t value = 0;
+
+        EXPECT_EQ(test_map.find(key, value), key % 2 == 0);
+        if (key % 2 == 0)
+        {
+            EXPECT_EQ(value, -key);
+        }
+    }
+}
@@ -0,0 +1,87 @@
+#include "frozen_splay_tree.h"
+#include <gtest/gtest.h>
+
+#include <map>
+#include <cstdint>
+#include <ctime>
+#include <cstdlib>
+
+
+TEST(FrozenSplayTreeLowerBound, StdMap)
+{
+    splay_tree<int32_t, int32_t> test_tree;
+    std::map<int32_t, int32_t> std_tree;
+
+    srand(time(NULL));
+
+    const size_t N = 100;
+
+    for (size_t i = 0; i < N; ++i)
+    {
+        std::pair<const int32_t, int32_t> value = std::make_pair(rand() % (2 * N), rand());
+
+        test_tree.insert(value);
+        std_tree.insert(value);
+    }
+
+    frozen_splay_tree frozen(test_tree);
+
+    ASSERT_EQ(frozen.size(), std_tree.size());
+
+    for (int32_t key = -1; key <= (int32_t)(2 * N); ++key)
+    {
+        auto it = frozen.lower_bound(key);
+        auto std_it = std_tree.lower_bound(key);
+
+        if (std_it == std_tree.end())
+            EXPECT_TRUE(it == frozen.end());
+        else
+        {
+            ASSERT_TRUE(it != frozen.end());
+            EXPECT_EQ((*it).first, std_it->first);
+            EXPECT_EQ((*it).second, std_it->second);
+        }
+
+        EXPECT_EQ(frozen.contains(key), std_tree.count(key) == 1);
+    }
+}
+
+TEST(FrozenSplayTreeIteration, StdMap)
+{
+    std::map<int32_t, int32_t> std_tree;
+
+    srand(time(NULL));
+
+    const size_t N = 100;
+
+    for (size_t i = 0; i < N; ++i)
+        std_tree.insert(std::make_pair(rand() % (2 * N), rand()));
+
+    splay_tree<int32_t, int32_t> test_tree(std_tree.begin(), std_tree.end());
+    frozen_splay_tree frozen(test_tree);
+
+    auto std_it = std_tree.begin();
+    for (auto it = frozen.begin(); it != frozen.end(); ++it, ++std_it)
+    {
+        ASSERT_TRUE(std_it != std_tree.end());
+        EXPECT_EQ((*it).first, std_it->first);
+    }
+    EXPECT_TRUE(std_it == std_tree.end());
+
+    auto thawed = frozen.thaw();
+
+    EXPECT_EQ(thawed.size(), std_tree.size());
+    for (auto& x : std_tree)
+        EXPECT_EQ(thawed.find(x.first)->second, x.second);
+}
+
+TEST(FrozenSplayTreeEmpty, Empty)
+{
+    splay_tree<int32_t, int32_t> test_tree;
+    frozen_splay_tree frozen(test_tree);
+
+    EXPECT_TRUE(frozen.empty());
+    EXPECT_TRUE(frozen.begin() == frozen.end());
+    EXPECT_TRUE(frozen.find(0) == frozen.end());
+    EXPECT_TRUE(frozen.thaw().empty());
+}
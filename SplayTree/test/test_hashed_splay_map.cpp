@@ -0,0 +1,162 @@
+#include "hashed_splay_map.h"
+#include <gtest/gtest.h>
+
+#include <map>
+#include <cstdint>
+#include <ctime>
+#include <cstdlib>
+
+
+TEST(HashedSplayMapRandomInsertEraseFind, StdMap)
+{
+    hashed_splay_map<int32_t, int32_t> test_map;
+    std::map<int32_t, int32_t> std_map;
+
+    srand(time(NULL));
+
+    const size_t N = 5000;
+
+    for (size_t i = 0; i < N; ++i)
+    {
+        int32_t key = rand() % 1000;
+
+        switch (rand() % 4)
+        {
+        case 0:
+        {
+            std::pair<const int32_t, int32_t> value = std::make_pair(key, rand());
+
+            EXPECT_EQ(test_map.insert(value).second, std_map.insert(value).second);
+            break;
+        }
+        case 1:
+        {
+            int32_t obj = rand();
+
+            EXPECT_EQ(test_map.insert_or_assign(key, obj).second, std_map.insert_or_assign(key, obj).second);
+            break;
+        }
+        case 2:
+            EXPECT_EQ(test_map.erase(key), std_map.erase(key));
+            break;
+        case 3:
+        {
+            auto x = test_map.find(key);
+            auto std_it = std_map.find(key);
+
+            if (std_it == std_map.end())
+                EXPECT_EQ(x, nullptr);
+            else
+            {
+                ASSERT_NE(x, nullptr);
+                EXPECT_EQ(x->second, std_it->second);
+            }
+            break;
+        }
+        }
+
+        EXPECT_EQ(test_map.size(), std_map.size());
+    }
+
+    auto std_it = std_map.begin();
+    for (auto it = test_map.begin(); it != test_map.end(); ++it, ++std_it)
+    {
+        ASSERT_TRUE(std_it != std_map.end());
+        EXPECT_EQ(it->first, std_it->first);
+        EXPECT_EQ(it->second, std_it->second);
+    }
+    EXPECT_TRUE(std_it == std_map.end());
+}
+
+TEST(HashedSplayMapInsert, ExistingKeyWithoutDescent)
+{
+    struct counting_less
+    {
+        size_t* calls;
+
+        bool operator() (int32_t a, int32_t b) const { ++*calls; return a < b; }
+    };
+
+    size_t calls = 0;
+    hashed_splay_map<int32_t, int32_t, std::hash<int32_t>, counting_less> test_map(std::hash<int32_t>{}, counting_less{ &calls });
+
+    const int32_t N = 1000;
+
+    for (int32_t key = 0; key < N; ++key)
+        test_map.insert(std::make_pair(key, key));
+
+    for (int32_t key = 0; key < N - 1; ++key)
+    {
+        calls = 0;
+        auto result = test_map.insert_or_assign(key, -key);
+
+        EXPECT_FALSE(result.second);
+        EXPECT_EQ(result.first->first, key);
+        EXPECT_EQ(result.first->second, -key);
+        EXPECT_EQ((++result.first)->first, key + 1);
+        EXPECT_LE(calls, (size_t)2); // only the key equivalence check of the hash index
+
+        calls = 0;
+        result = test_map.insert(std::make_pair(key, 0));
+
+        EXPECT_FALSE(result.second);
+        EXPECT_EQ(result.first->second, -key);
+        EXPECT_LE(calls, (size_t)2);
+    }
+
+    for (int32_t key = 0; key < N; key += 2)
+        EXPECT_EQ(test_map.erase(key), (size_t)1);
+
+    EXPECT_EQ(test_map.size(), (size_t)N / 2);
+
+    int32_t expected = 1;
+    for (auto it = test_map.begin(); it != test_map.end(); ++it, expected += 2)
+        EXPECT_EQ(it->first, expected);
+}
+
+TEST(HashedSplayMapEraseRange, Collisions)
+{
+    // every key of a group falls into one probe sequence, erase has to shift them back
+    struct group_hash { size_t operator() (int32_t key) const { return (size_t)(key / 8); } };
+
+    hashed_splay_map<int32_t, int32_t, group_hash> test_map;
+    std::map<int32_t, int32_t> std_map;
+
+    srand(time(NULL));
+
+    const int32_t N = 500;
+
+    for (int32_t key = 0; key < N; ++key)
+    {
+        test_map.insert(std::make_pair(key, key));
+        std_map.insert(std::make_pair(key, key));
+    }
+
+    for (size_t i = 0; i < 20; ++i)
+    {
+        int32_t lo = rand() % N;
+        int32_t hi = lo + rand() % 30;
+
+        EXPECT_EQ(test_map.erase_range(lo, hi), (size_t)std::distance(std_map.lower_bound(lo), std_map.lower_bound(hi)));
+        std_map.erase(std_map.lower_bound(lo), std_map.lower_bound(hi));
+
+        ASSERT_EQ(test_map.size(), std_map.size());
+
+        for (int32_t key = 0; key < N; ++key)
+            EXPECT_EQ(test_map.contains(key), std_map.count(key) == 1);
+    }
+
+    for (int32_t key = -1; key <= N; ++key)
+    {
+        auto it = test_map.lower_bound(key);
+        auto std_it = std_map.lower_bound(key);
+
+        if (std_it == std_map.end())
+            EXPECT_TRUE(it == test_map.end());
+        else
+        {
+            ASSERT_TRUE(it != test_map.end());
+            EXPECT_EQ(it->first, std_it->first);
+        }
+    }
+}
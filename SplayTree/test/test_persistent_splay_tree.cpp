@@ -0,0 +1,229 @@
+#include "persistent_splay_tree.h"
+#include <gtest/gtest.h>
+
+#include <map>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+#include <ctime>
+#include <cstdlib>
+
+
+TEST(PersistentSplayTreeRandomInsertEraseFind, StdMap)
+{
+    persistent_splay_tree<int32_t, int32_t> test_tree;
+    std::map<int32_t, int32_t> std_tree;
+
+    srand(time(NULL));
+
+    const size_t N = 1000;
+
+    for (size_t i = 0; i < N; ++i)
+    {
+        int32_t key = rand() % 200;
+
+        switch (rand() % 3)
+        {
+        case 0:
+        {
+            std::pair<const int32_t, int32_t> value = std::make_pair(key, rand());
+
+            EXPECT_EQ(test_tree.insert(value), std_tree.insert(value).second);
+            break;
+        }
+        case 1:
+            EXPECT_EQ(test_tree.erase(key), std_tree.erase(key));
+            break;
+        case 2:
+        {
+            auto x = test_tree.find(key);
+            auto std_it = std_tree.find(key);
+
+            if (std_it == std_tree.end())
+                EXPECT_EQ(x, nullptr);
+            else
+            {
+                ASSERT_NE(x, nullptr);
+                EXPECT_EQ(x->second, std_it->second);
+            }
+            break;
+        }
+        }
+
+        EXPECT_EQ(test_tree.size(), std_tree.size());
+    }
+}
+
+struct counted_value
+{
+    int32_t x;
+
+    static size_t copies;
+
+    counted_value(int32_t x) : x(x) {}
+    counted_value(const counted_value& other) : x(other.x) { ++copies; }
+};
+
+size_t counted_value::copies = 0;
+
+TEST(PersistentSplayTreeFind, CopiesOnlySharedNodes)
+{
+    persistent_splay_tree<int32_t, counted_value> test_tree;
+
+    const int32_t N = 1000;
+
+    for (int32_t key = 0; key < N; ++key)
+        test_tree.insert(std::make_pair(key, counted_value(key)));
+
+    // without snapshots the path is splayed in place
+    counted_value::copies = 0;
+    for (int32_t key = 0; key < N; key += 7)
+    {
+        ASSERT_NE(test_tree.find(key), nullptr);
+        EXPECT_EQ(test_tree.find(key)->second.x, key);
+    }
+    test_tree.erase(N / 2);
+    EXPECT_EQ(counted_value::copies, (size_t)0);
+
+    // the path shared with a snapshot is copied once, then changed in place
+    auto snapshot = test_tree.snapshot();
+
+    test_tree.find(0);
+    EXPECT_GT(counted_value::copies, (size_t)0);
+
+    counted_value::copies = 0;
+    test_tree.find(0);
+    EXPECT_EQ(counted_value::copies, (size_t)0);
+
+    EXPECT_EQ(snapshot.size(), (size_t)N - 1);
+    ASSERT_NE(snapshot.find(N - 1), nullptr);
+    EXPECT_EQ(snapshot.find(N - 1)->second.x, N - 1);
+}
+
+TEST(PersistentSplayTreeSnapshot, Isolation)
+{
+    persistent_splay_tree<int32_t, int32_t> test_tree;
+    std::map<int32_t, int32_t> std_tree;
+
+    srand(time(NULL));
+
+    const size_t N = 200;
+
+    std::vector<std::map<int32_t, int32_t>> std_versions;
+    std::vector<persistent_splay_tree<int32_t, int32_t>::snapshot_type> versions;
+
+    for (size_t i = 0; i < N; ++i)
+    {
+        int32_t key = rand() % 100;
+
+        if (rand() % 3 != 0)
+        {
+            test_tree.insert(std::make_pair(key, (int32_t)i));
+            std_tree.insert(std::make_pair(key, (int32_t)i));
+        }
+        else
+        {
+            test_tree.erase(key);
+            std_tree.erase(key);
+        }
+
+        test_tree.find(rand() % 100);
+
+        if (i % 10 == 0)
+        {
+            versions.push_back(test_tree.snapshot());
+            std_versions.push_back(std_tree);
+        }
+    }
+
+    // every snapshot still shows the elements of its version
+    for (size_t v = 0; v < versions.size(); ++v)
+    {
+        ASSERT_EQ(versions[v].size(), std_versions[v].size());
+
+        auto std_it = std_versions[v].begin();
+        versions[v].for_each([&](const std::pair<const int32_t, int32_t>& x)
+        {
+            ASSERT_TRUE(std_it != std_versions[v].end());
+            EXPECT_EQ(x.first, std_it->first);
+            EXPECT_EQ(x.second, std_it->second);
+            ++std_it;
+        });
+        EXPECT_TRUE(std_it == std_versions[v].end());
+
+        for (int32_t key = -1; key <= 100; ++key)
+        {
+            auto bound = versions[v].lower_bound(key);
+            auto std_bound = std_versions[v].lower_bound(key);
+
+            if (std_bound == std_versions[v].end())
+                EXPECT_EQ(bound, nullptr);
+            else
+            {
+                ASSERT_NE(bound, nullptr);
+                EXPECT_EQ(bound->first, std_bound->first);
+            }
+
+            EXPECT_EQ(versions[v].contains(key), std_versions[v].count(key) == 1);
+        }
+    }
+
+    // snapshots outlive the tree
+    persistent_splay_tree<int32_t, int32_t>::snapshot_type last;
+    {
+        persistent_splay_tree<int32_t, int32_t> tree;
+        tree.insert(std::make_pair(1, 1));
+        last = tree.snapshot();
+    }
+    ASSERT_NE(last.find(1), nullptr);
+    EXPECT_EQ(last.find(1)->second, 1);
+}
+
+TEST(PersistentSplayTreeSnapshot, ConcurrentReaders)
+{
+    persistent_splay_tree<int32_t, int32_t> test_tree;
+
+    const int32_t N = 20000;
+
+    std::atomic<bool> done(false);
+    std::vector<std::thread> readers;
+
+    for (int r = 0; r < 4; ++r)
+        readers.emplace_back([&]()
+        {
+            while (!done.load())
+            {
+                auto snapshot = test_tree.snapshot();
+
+                // the writer inserts keys in order, so a version holds exactly keys [0, size)
+                size_t n = 0;
+                bool consistent = true;
+                snapshot.for_each([&](const std::pair<const int32_t, int32_t>& x)
+                {
+                    consistent = consistent && (x.first == (int32_t)n) && (x.second == -x.first);
+                    ++n;
+                });
+
+                EXPECT_TRUE(consistent);
+                EXPECT_EQ(n, snapshot.size());
+                if (n != 0)
+                {
+                    EXPECT_TRUE(snapshot.contains((int32_t)n - 1));
+                }
+                EXPECT_FALSE(snapshot.contains((int32_t)n));
+            }
+        });
+
+    for (int32_t key = 0; key < N; ++key)
+    {
+        test_tree.insert(std::make_pair(key, -key));
+        test_tree.find(key / 2);
+    }
+
+    done.store(true);
+    for (auto& t : readers)
+        t.join();
+
+    EXPECT_EQ(test_tree.size(), (size_t)N);
+}
@@ -0,0 +1,203 @@
+#include "splay_cache.h"
+#include <gtest/gtest.h>
+
+#include <list>
+#include <map>
+#include <string>
+#include <utility>
+#include <cstdint>
+#include <ctime>
+#include <cstdlib>
+
+
+TEST(SplayCacheGetPut, LRU)
+{
+    splay_cache<int32_t, int32_t> cache(2);
+
+    EXPECT_TRUE(cache.put(1, 10));
+    EXPECT_TRUE(cache.put(2, 20));
+
+    ASSERT_NE(cache.get(1), nullptr);
+    EXPECT_EQ(*cache.get(1), 10);
+
+    EXPECT_TRUE(cache.put(3, 30)); // evicts 2
+
+    EXPECT_EQ(cache.get(2), nullptr);
+    EXPECT_EQ(*cache.get(3), 30);
+    EXPECT_EQ(cache.size(), (size_t)2);
+
+    EXPECT_TRUE(cache.put(1, 11)); // update makes 1 the most recently used
+    EXPECT_TRUE(cache.put(4, 40)); // evicts 3
+
+    EXPECT_EQ(cache.get(3), nullptr);
+    EXPECT_EQ(*cache.get(1), 11);
+
+    EXPECT_EQ(cache.stats().evictions, (size_t)2);
+    EXPECT_EQ(cache.stats().misses, (size_t)2);
+    EXPECT_EQ(cache.stats().hits, (size_t)4);
+
+    EXPECT_TRUE(cache.erase(1));
+    EXPECT_FALSE(cache.erase(1));
+    EXPECT_EQ(cache.size(), (size_t)1);
+}
+
+TEST(SplayCacheGetPut, ByteCapacity)
+{
+    struct string_bytes { size_t operator() (int32_t, const std::string& s) const { return s.size(); } };
+
+    splay_cache<int32_t, std::string, std::less<>, string_bytes> cache(10);
+
+    EXPECT_TRUE(cache.put(1, "aaaa"));
+    EXPECT_TRUE(cache.put(2, "bbbb"));
+    EXPECT_EQ(cache.weight(), (size_t)8);
+
+    EXPECT_TRUE(cache.put(3, "cccc")); // evicts 1
+    EXPECT_EQ(cache.get(1), nullptr);
+    EXPECT_EQ(cache.weight(), (size_t)8);
+
+    EXPECT_FALSE(cache.put(4, "too long value"));
+    EXPECT_EQ(cache.get(4), nullptr);
+}
+
+TEST(SplayCacheGetPut, UpdateDoesNotCopyConstruct)
+{
+    struct counted
+    {
+        counted(int32_t x, size_t* copies) : x(x), copies(copies) {}
+        counted(const counted& other) : x(other.x), copies(other.copies) { ++*copies; }
+        counted& operator= (const counted& other) = default;
+
+        int32_t x;
+        size_t* copies;
+    };
+
+    size_t copies = 0;
+    splay_cache<int32_t, counted> cache(2);
+
+    EXPECT_TRUE(cache.put(1, counted(10, &copies)));
+    EXPECT_EQ(copies, (size_t)1);
+
+    EXPECT_TRUE(cache.put(1, counted(11, &copies))); // assigned in place
+    EXPECT_EQ(copies, (size_t)1);
+    EXPECT_EQ(cache.get(1)->x, 11);
+    EXPECT_EQ(cache.size(), (size_t)1);
+}
+
+TEST(SplayCacheMove, SourceIsEmpty)
+{
+    splay_cache<int32_t, int32_t> cache(2);
+
+    cache.put(1, 10);
+    cache.put(2, 20);
+
+    splay_cache<int32_t, int32_t> moved(std::move(cache));
+
+    EXPECT_EQ(moved.size(), (size_t)2);
+    EXPECT_EQ(moved.weight(), (size_t)2);
+    EXPECT_EQ(*moved.get(1), 10);
+
+    EXPECT_TRUE(cache.empty());
+    EXPECT_EQ(cache.weight(), (size_t)0);
+
+    // the moved-from cache is usable
+    EXPECT_TRUE(cache.put(3, 30));
+    EXPECT_TRUE(cache.put(4, 40));
+    EXPECT_TRUE(cache.put(5, 50)); // evicts 3
+    EXPECT_EQ(cache.get(3), nullptr);
+    EXPECT_EQ(cache.size(), (size_t)2);
+
+    moved = std::move(cache);
+
+    EXPECT_EQ(*moved.get(5), 50);
+    EXPECT_EQ(moved.get(1), nullptr);
+    EXPECT_TRUE(cache.empty());
+
+    EXPECT_TRUE(moved.put(6, 60)); // evicts 4
+    EXPECT_EQ(moved.get(4), nullptr);
+    EXPECT_TRUE(moved.erase(5));
+    EXPECT_EQ(moved.size(), (size_t)1);
+}
+
+TEST(SplayCacheEvict, NoKeySearch)
+{
+    struct counting_less
+    {
+        size_t* calls;
+
+        bool operator() (int32_t a, int32_t b) const { ++*calls; return a < b; }
+    };
+
+    size_t calls = 0;
+    splay_cache<int32_t, int32_t, counting_less> cache(1, splay_cache_unit_weight{}, counting_less{ &calls });
+
+    EXPECT_TRUE(cache.put(1, 10));
+
+    calls = 0;
+    EXPECT_TRUE(cache.put(2, 20)); // evicts 1 after inserting 2 under it
+
+    EXPECT_LE(calls, (size_t)2); // only the insertion of 2 compares keys
+    EXPECT_EQ(cache.stats().evictions, (size_t)1);
+    EXPECT_EQ(cache.size(), (size_t)1);
+}
+
+TEST(SplayCacheRandomGetPut, ReferenceLRU)
+{
+    const size_t capacity = 10;
+
+    splay_cache<int32_t, int32_t> cache(capacity);
+
+    std::list<std::pair<int32_t, int32_t>> lru; // most recently used first
+    std::map<int32_t, std::list<std::pair<int32_t, int32_t>>::iterator> index;
+
+    srand(time(NULL));
+
+    const size_t N = 1000;
+
+    for (size_t i = 0; i < N; ++i)
+    {
+        int32_t key = rand() % (3 * capacity);
+        auto it = index.find(key);
+
+        switch (rand() % 2)
+        {
+        case 0: // get
+        {
+            int32_t* value = cache.get(key);
+
+            if (it == index.end())
+                EXPECT_EQ(value, nullptr);
+            else
+            {
+                ASSERT_NE(value, nullptr);
+                EXPECT_EQ(*value, it->second->second);
+
+                lru.splice(lru.begin(), lru, it->second);
+            }
+
+            break;
+        }
+        case 1: // put
+        {
+            int32_t value = rand();
+
+            cache.put(key, value);
+
+            if (it != index.end())
+                lru.erase(it->second);
+
+            lru.emplace_front(key, value);
+            index[key] = lru.begin();
+
+            if (lru.size() > capacity)
+            {
+                index.erase(lru.back().first);
+                lru.pop_back();
+            }
+
+            break;
+        }
+        }
+
+        EXPECT_EQ(cache.size(), lru.size());
+    }
+}
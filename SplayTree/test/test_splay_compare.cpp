@@ -0,0 +1,98 @@
+#include "splay_tree.h"
+#include <gtest/gtest.h>
+
+#include <map>
+#include <string>
+#include <string_view>
+#include <functional>
+#include <cstdint>
+#include <ctime>
+#include <cstdlib>
+
+// Built as C++20 to cover the <=> path of three_way_compare
+
+
+struct counted_key
+{
+    int32_t x;
+
+    static size_t less_calls;
+    static size_t three_way_calls;
+
+    friend bool operator< (const counted_key& a, const counted_key& b) { ++less_calls; return a.x < b.x; }
+    friend bool operator> (const counted_key& a, const counted_key& b) { ++less_calls; return a.x > b.x; }
+    friend bool operator== (const counted_key& a, const counted_key& b) { return a.x == b.x; }
+#if defined(__cpp_lib_three_way_comparison)
+    friend std::strong_ordering operator<=> (const counted_key& a, const counted_key& b) { ++three_way_calls; return a.x <=> b.x; }
+#endif
+};
+
+size_t counted_key::less_calls = 0;
+size_t counted_key::three_way_calls = 0;
+
+
+TEST(ThreeWayCompare, Strings)
+{
+    const std::string a = "abc", b = "abd";
+
+    EXPECT_LT(three_way_compare(std::less<>{}, a, b), 0);
+    EXPECT_GT(three_way_compare(std::less<>{}, b, a), 0);
+    EXPECT_EQ(three_way_compare(std::less<>{}, a, std::string_view("abc")), 0);
+    EXPECT_GT(three_way_compare(std::greater<std::string>{}, a, b), 0);
+    EXPECT_LT(three_way_compare(std::less<>{}, std::string_view("ab"), a), 0);
+    EXPECT_GT(three_way_compare(std::less<>{}, a, "ab"), 0);
+}
+
+TEST(ThreeWayCompare, SingleComparison)
+{
+    counted_key::less_calls = counted_key::three_way_calls = 0;
+
+    EXPECT_LT(three_way_compare(std::less<>{}, counted_key{ 1 }, counted_key{ 2 }), 0);
+    EXPECT_EQ(three_way_compare(std::less<counted_key>{}, counted_key{ 2 }, counted_key{ 2 }), 0);
+    EXPECT_LT(three_way_compare(std::greater<>{}, counted_key{ 3 }, counted_key{ 2 }), 0);
+
+#if defined(__cpp_lib_three_way_comparison) && defined(__cpp_lib_concepts)
+    EXPECT_EQ(counted_key::less_calls, (size_t)0);
+    EXPECT_EQ(counted_key::three_way_calls, (size_t)3);
+#else
+    EXPECT_EQ(counted_key::less_calls, (size_t)4); // equal keys take both directions
+#endif
+
+    // other Compare is always called
+    counted_key::less_calls = counted_key::three_way_calls = 0;
+
+    auto by_less = [](const counted_key& a, const counted_key& b) { return a < b; };
+
+    EXPECT_GT(three_way_compare(by_less, counted_key{ 2 }, counted_key{ 1 }), 0);
+    EXPECT_EQ(counted_key::less_calls, (size_t)2);
+    EXPECT_EQ(counted_key::three_way_calls, (size_t)0);
+}
+
+TEST(ThreeWayCompare, StringTreeStdMap)
+{
+    splay_tree<std::string, int32_t> test_tree;
+    splay_tree<std::string, int32_t, std::greater<std::string>> reverse_tree;
+    std::map<std::string, int32_t> std_tree;
+
+    srand(time(NULL));
+
+    for (size_t i = 0; i < 1000; ++i)
+    {
+        std::string key = std::to_string(rand() % 500);
+
+        test_tree.insert(std::make_pair(key, (int32_t)i));
+        reverse_tree.insert(std::make_pair(key, (int32_t)i));
+        std_tree.insert(std::make_pair(key, (int32_t)i));
+    }
+
+    EXPECT_EQ(test_tree.size(), std_tree.size());
+
+    auto it = test_tree.begin();
+    for (auto& x : std_tree)
+    {
+        EXPECT_EQ(it->first, x.first);
+        EXPECT_EQ(test_tree.find(std::string_view(x.first))->second, x.second);
+        EXPECT_EQ(reverse_tree.find(x.first)->second, x.second);
+        ++it;
+    }
+}
@@ -0,0 +1,119 @@
+#include "splay_rope.h"
+#include <gtest/gtest.h>
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <ctime>
+#include <cstdlib>
+
+
+static std::vector<int32_t> to_vector(splay_rope<int32_t>& rope)
+{
+    std::vector<int32_t> v;
+    rope.for_each([&v](int32_t x) { v.push_back(x); });
+
+    return v;
+}
+
+TEST(SplayRopeRandomEdit, StdVector)
+{
+    splay_rope<int32_t> test_rope;
+    std::vector<int32_t> std_vector;
+
+    srand(time(NULL));
+
+    const size_t N = 5000;
+
+    for (size_t i = 0; i < N; ++i)
+    {
+        switch (rand() % 4)
+        {
+        case 0:
+        {
+            size_t pos = rand() % (std_vector.size() + 1);
+            int32_t value = rand();
+
+            test_rope.insert_at(pos, value);
+            std_vector.insert(std_vector.begin() + pos, value);
+            break;
+        }
+        case 1:
+            if (!std_vector.empty())
+            {
+                size_t pos = rand() % std_vector.size();
+
+                test_rope.erase_at(pos);
+                std_vector.erase(std_vector.begin() + pos);
+            }
+            break;
+        case 2:
+        {
+            size_t first = rand() % (std_vector.size() + 1);
+            size_t last = first + rand() % (std_vector.size() - first + 1);
+
+            test_rope.reverse(first, last);
+            std::reverse(std_vector.begin() + first, std_vector.begin() + last);
+            break;
+        }
+        case 3:
+            if (!std_vector.empty())
+            {
+                size_t pos = rand() % std_vector.size();
+
+                EXPECT_EQ(test_rope.at(pos), std_vector[pos]);
+            }
+            break;
+        }
+
+        ASSERT_EQ(test_rope.size(), std_vector.size());
+    }
+
+    EXPECT_EQ(to_vector(test_rope), std_vector);
+}
+
+TEST(SplayRopeSplitConcat, StdVector)
+{
+    std::vector<int32_t> std_vector;
+    for (int32_t i = 0; i < 1000; ++i)
+        std_vector.push_back(i);
+
+    splay_rope<int32_t> test_rope(std_vector.begin(), std_vector.end());
+
+    srand(time(NULL));
+
+    for (size_t i = 0; i < 200; ++i)
+    {
+        // cut a piece and move it to the end reversed
+        size_t first = rand() % std_vector.size();
+        size_t last = first + rand() % (std_vector.size() - first + 1);
+
+        splay_rope<int32_t> middle = test_rope.split_at(first);
+        splay_rope<int32_t> right = middle.split_at(last - first);
+
+        EXPECT_EQ(test_rope.size(), first);
+        EXPECT_EQ(middle.size(), last - first);
+
+        middle.reverse(0, middle.size());
+
+        test_rope.concat(right);
+        test_rope.concat(middle);
+        EXPECT_TRUE(right.empty());
+        EXPECT_TRUE(middle.empty());
+
+        std::vector<int32_t> piece(std_vector.begin() + first, std_vector.begin() + last);
+        std::reverse(piece.begin(), piece.end());
+        std_vector.erase(std_vector.begin() + first, std_vector.begin() + last);
+        std_vector.insert(std_vector.end(), piece.begin(), piece.end());
+    }
+
+    EXPECT_EQ(to_vector(test_rope), std_vector);
+
+    test_rope.push_back(-1);
+    EXPECT_EQ(test_rope.at(test_rope.size() - 1), -1);
+
+    EXPECT_THROW(test_rope.at(test_rope.size()), std::out_of_range);
+    EXPECT_THROW(test_rope.insert_at(test_rope.size() + 1, 0), std::out_of_range);
+    EXPECT_THROW(test_rope.erase_at(test_rope.size()), std::out_of_range);
+    EXPECT_THROW(test_rope.reverse(2, 1), std::out_of_range);
+}
@@ -2,6 +2,12 @@
 #include <gtest/gtest.h>
 
 #include <map>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <memory>
+#include <algorithm>
+#include <iterator>
 #include <queue>
 #include <cstdint>
 #include <ctime>
@@ -42,11 +48,685 @@ TEST(SplayTreeRandomInsertExctract, StdMap)
                 auto a1 = test_tree.extract(x.first);
                 auto a2 = std_tree.extract(x.first);
 
-                if (a1 != splay_tree<int32_t, int32_t>::value_type())
-                    EXPECT_EQ(a1.second, a2.mapped());
-                    
+                EXPECT_EQ(a1.empty(), a2.empty());
+                if (!a1.empty())
+                {
+                    EXPECT_EQ(a1.mapped(), a2.mapped());
+                }
+
+            }
+        }
+        }
+    }
+}
+
+TEST(SplayTreeSplitJoin, StdMap)
+{
+    splay_tree<int32_t, int32_t> test_tree;
+    std::map<int32_t, int32_t> std_tree;
+
+    srand(time(NULL));
+
+    const size_t N = 100;
+
+    for (size_t i = 0; i < N; ++i)
+    {
+        std::pair<const int32_t, int32_t> value = std::make_pair(rand() % N, rand());
+
+        EXPECT_EQ(test_tree.insert(value).second, std_tree.insert(value).second);
+    }
+
+    const int32_t pivot = rand() % N;
+
+    auto right = test_tree.split(pivot);
+    auto bound = std_tree.lower_bound(pivot);
+
+    EXPECT_EQ(test_tree.size(), (size_t)std::distance(std_tree.begin(), bound));
+    EXPECT_EQ(right.size(), (size_t)std::distance(bound, std_tree.end()));
+
+    for (auto& x : std_tree)
+    {
+        auto& part = (x.first < pivot) ? test_tree : right;
+        auto& other = (x.first < pivot) ? right : test_tree;
+
+        EXPECT_EQ(part.find(x.first)->second, x.second);
+        EXPECT_FALSE(other.find(x.first) != other.end());
+    }
+
+    EXPECT_THROW(right.join(test_tree), std::invalid_argument);
+
+    test_tree.join(right);
+
+    EXPECT_TRUE(right.empty());
+    EXPECT_EQ(test_tree.size(), std_tree.size());
+
+    for (auto& x : std_tree)
+        EXPECT_EQ(test_tree.find(x.first)->second, x.second);
+}
+
+TEST(SplayTreeEraseRange, StdMap)
+{
+    splay_tree<int32_t, int32_t> test_tree;
+    std::map<int32_t, int32_t> std_tree;
+
+    srand(time(NULL));
+
+    const size_t N = 100;
+
+    for (size_t i = 0; i < N; ++i)
+    {
+        std::pair<const int32_t, int32_t> value = std::make_pair(rand() % N, rand());
+
+        test_tree.insert(value);
+        std_tree.insert(value);
+    }
+
+    for (size_t i = 0; i < 10; ++i)
+    {
+        int32_t lo = rand() % N, hi = rand() % N;
+
+        size_t expected = 0;
+        if (lo < hi)
+        {
+            auto first = std_tree.lower_bound(lo), last = std_tree.lower_bound(hi);
+
+            expected = std::distance(first, last);
+            std_tree.erase(first, last);
+        }
+
+        EXPECT_EQ(test_tree.erase_range(lo, hi), expected);
+        EXPECT_EQ(test_tree.size(), std_tree.size());
+    }
+
+    for (auto& x : std_tree)
+        EXPECT_EQ(test_tree.find(x.first)->second, x.second);
+
+    auto range = test_tree.extract_range(0, (int32_t)N / 2);
+
+    EXPECT_EQ(range.size() + test_tree.size(), std_tree.size());
+}
+
+TEST(SplayTreeSortedBuild, StdMap)
+{
+    std::map<int32_t, int32_t> std_tree;
+
+    srand(time(NULL));
+
+    const size_t N = 100;
+
+    for (size_t i = 0; i < N; ++i)
+        std_tree.insert(std::make_pair(rand() % N, rand()));
+
+    splay_tree<int32_t, int32_t> test_tree(std_tree.begin(), std_tree.end());
+
+    EXPECT_EQ(test_tree.size(), std_tree.size());
+
+    for (auto& x : std_tree)
+        EXPECT_EQ(test_tree.find(x.first)->second, x.second);
+
+    std::vector<std::pair<int32_t, int32_t>> unsorted = { {2, 0}, {1, 0} };
+    EXPECT_THROW((splay_tree<int32_t, int32_t>(unsorted.begin(), unsorted.end())), std::invalid_argument);
+}
+
+TEST(SplayTreeInsertSorted, StdMap)
+{
+    splay_tree<int32_t, int32_t> test_tree;
+    std::map<int32_t, int32_t> std_tree;
+
+    srand(time(NULL));
+
+    const size_t N = 100;
+
+    // batches of different sizes take both the one-by-one and the rebuilding path
+    for (size_t batch_size : { (size_t)1, (size_t)3, N })
+    {
+        std::map<int32_t, int32_t> batch;
+
+        for (size_t i = 0; i < batch_size; ++i)
+            batch.insert(std::make_pair(rand() % (2 * N), rand()));
+
+        size_t expected = 0;
+        for (auto& x : batch)
+            expected += std_tree.insert(x).second;
+
+        EXPECT_EQ(test_tree.insert_sorted(batch.begin(), batch.end()), expected);
+        EXPECT_EQ(test_tree.size(), std_tree.size());
+    }
+
+    for (auto& x : std_tree)
+        EXPECT_EQ(test_tree.find(x.first)->second, x.second);
+}
+
+TEST(SplayTreeInsertSorted, EmptyTreeIsBalanced)
+{
+    const int32_t N = 100000;
+
+    std::vector<std::pair<int32_t, int32_t>> values;
+    for (int32_t i = 0; i < N; ++i)
+        values.push_back(std::make_pair(i, i));
+
+    splay_tree<int32_t, int32_t> test_tree;
+
+    EXPECT_EQ(test_tree.insert_sorted(values.begin(), values.end()), (size_t)N);
+    EXPECT_EQ(test_tree.size(), (size_t)N);
+    EXPECT_EQ(test_tree.rotations(), (size_t)0);
+    EXPECT_EQ(test_tree.stats().height, (size_t)17); // ceil(log2(N + 1))
+}
+
+TEST(SplayTreeInsertSorted, FingerSearch)
+{
+    struct counting_less
+    {
+        size_t* calls;
+
+        bool operator() (int32_t a, int32_t b) const { ++*calls; return a < b; }
+    };
+
+    const int32_t N = 1 << 16, M = 256;
+
+    std::vector<std::pair<int32_t, int32_t>> values, batch;
+    for (int32_t i = 0; i < N; ++i)
+        values.push_back(std::make_pair(2 * i, 2 * i));
+    for (int32_t i = 0; i < M; ++i)
+        batch.push_back(std::make_pair(N + 2 * i + 1, 0)); // odd keys between neighbouring elements, small batch
+    batch.push_back(std::make_pair(N + 2 * M, 0)); // existing key
+
+    size_t calls = 0;
+    splay_tree<int32_t, int32_t, counting_less, depth_threshold_splay_policy> test_tree(values.begin(), values.end(), counting_less{ &calls });
+    splay_tree<int32_t, int32_t, counting_less, depth_threshold_splay_policy> root_tree(values.begin(), values.end(), counting_less{ &calls });
+
+    calls = 0;
+    EXPECT_EQ(test_tree.insert_sorted(batch.begin(), batch.end()), (size_t)M);
+    size_t finger_calls = calls;
+
+    calls = 0;
+    for (auto& x : batch)
+        root_tree.insert(x);
+    size_t root_calls = calls;
+
+    // every root-to-leaf search passes about 16 levels of the unsplayed tree (about 21 comparisons),
+    // finger searches climb a few levels from the previous key (about 10 comparisons)
+    EXPECT_LT(3 * finger_calls, 2 * root_calls);
+
+    ASSERT_EQ(test_tree.size(), root_tree.size());
+    for (auto it = test_tree.begin(), root_it = root_tree.begin(); it != test_tree.end(); ++it, ++root_it)
+        EXPECT_EQ(it->first, root_it->first);
+    EXPECT_EQ(test_tree.stats().node_count, (size_t)(N + M));
+}
+
+TEST(SplayTreeTransparentFind, StringView)
+{
+    splay_tree<std::string, int32_t> test_tree;
+
+    test_tree.insert(std::make_pair(std::string("apple"), 1));
+    test_tree.insert(std::make_pair(std::string("banana"), 2));
+    test_tree.insert(std::make_pair(std::string("cherry"), 3));
+
+    std::string_view key = "banana";
+
+    EXPECT_EQ(test_tree.find(key)->second, 2);
+    EXPECT_FALSE(test_tree.find(std::string_view("durian")) != test_tree.end());
+
+    EXPECT_EQ(test_tree.erase(std::string_view("apple")), (size_t)1);
+    EXPECT_EQ(test_tree.erase(std::string_view("apple")), (size_t)0);
+    EXPECT_EQ(test_tree.size(), (size_t)2);
+}
+
+TEST(SplayTreeCustomCompare, NoEqualityOperator)
+{
+    struct key_type { int32_t x; };
+    struct key_less { bool operator() (const key_type& a, const key_type& b) const { return a.x < b.x; } };
+
+    splay_tree<key_type, int32_t, key_less> test_tree;
+
+    for (int32_t i = 0; i < 10; ++i)
+        EXPECT_TRUE(test_tree.insert(std::make_pair(key_type{ (i * 7) % 10 }, i)).second);
+
+    EXPECT_FALSE(test_tree.insert(std::make_pair(key_type{ 3 }, 0)).second);
+
+    for (int32_t i = 0; i < 10; ++i)
+        EXPECT_EQ(test_tree.find(key_type{ (i * 7) % 10 })->second, i);
+}
+
+TEST(SplayTreeFindBatch, StdMap)
+{
+    splay_tree<int32_t, int32_t> test_tree;
+    std::map<int32_t, int32_t> std_tree;
+
+    srand(time(NULL));
+
+    const size_t N = 100;
+
+    for (size_t i = 0; i < N; ++i)
+    {
+        std::pair<const int32_t, int32_t> value = std::make_pair(rand() % (2 * N), rand());
+
+        test_tree.insert(value);
+        std_tree.insert(value);
+    }
+
+    std::vector<int32_t> keys;
+    for (size_t i = 0; i < N; ++i)
+        keys.push_back(rand() % (2 * N));
+    std::sort(keys.begin(), keys.end());
+
+    std::vector<splay_tree<int32_t, int32_t>::iterator> found;
+    test_tree.find_batch(keys.begin(), keys.end(), std::back_inserter(found));
+
+    ASSERT_EQ(found.size(), keys.size());
+
+    for (size_t i = 0; i < keys.size(); ++i)
+    {
+        auto std_it = std_tree.find(keys[i]);
+
+        if (std_it == std_tree.end())
+            EXPECT_TRUE(found[i] == test_tree.end());
+        else
+        {
+            ASSERT_TRUE(found[i] != test_tree.end());
+            EXPECT_EQ(found[i]->second, std_it->second);
+        }
+    }
+}
+
+TEST(SplayTreeNth, StdMap)
+{
+    splay_tree<int32_t, int32_t> test_tree;
+    std::map<int32_t, int32_t> std_tree;
+
+    srand(time(NULL));
+
+    const size_t N = 1000;
+
+    for (size_t i = 0; i < N; ++i)
+    {
+        std::pair<const int32_t, int32_t> value = std::make_pair(rand() % (2 * N), rand());
+
+        test_tree.insert(value);
+        std_tree.insert(value);
+    }
+
+    std::vector<int32_t> std_keys;
+    for (auto& x : std_tree)
+        std_keys.push_back(x.first);
+
+    for (size_t i = 0; i < 2 * N; ++i)
+    {
+        size_t k = rand() % std_keys.size();
+        auto it = test_tree.nth(k);
+
+        ASSERT_TRUE(it != test_tree.end());
+        EXPECT_EQ(it->first, std_keys[k]);
+    }
+
+    EXPECT_TRUE(test_tree.nth(std_keys.size()) == test_tree.end());
+    EXPECT_EQ(test_tree.size(), std_tree.size());
+}
+
+TEST(SplayTreeCursor, StdMap)
+{
+    splay_tree<int32_t, int32_t> test_tree;
+    std::map<int32_t, int32_t> std_tree;
+
+    srand(time(NULL));
+
+    const size_t N = 100;
+
+    for (size_t i = 0; i < N; ++i)
+    {
+        std::pair<const int32_t, int32_t> value = std::make_pair(rand() % (2 * N), rand());
+
+        test_tree.insert(value);
+        std_tree.insert(value);
+    }
+
+    // iteration in key order
+    auto std_it = std_tree.begin();
+    for (auto it = test_tree.begin(); it != test_tree.end(); ++it, ++std_it)
+    {
+        ASSERT_TRUE(std_it != std_tree.end());
+        EXPECT_EQ(it->first, std_it->first);
+    }
+    EXPECT_TRUE(std_it == std_tree.end());
+
+    // forward seeks
+    auto c = test_tree.make_cursor();
+    for (int32_t key = 0; key < (int32_t)(2 * N); key += 1 + rand() % 5)
+    {
+        bool exact = c.seek(key);
+        auto bound = std_tree.lower_bound(key);
+
+        EXPECT_EQ(exact, std_tree.count(key) == 1);
+
+        if (bound == std_tree.end())
+            EXPECT_FALSE(c.valid());
+        else
+        {
+            ASSERT_TRUE(c.valid());
+            EXPECT_EQ(c->first, bound->first);
+
+            auto lb = test_tree.lower_bound(key); // restructures the tree under the cursor
+            EXPECT_EQ(lb->first, bound->first);
+        }
+    }
+}
+
+TEST(SplayTreeEmplace, MoveOnly)
+{
+    splay_tree<int32_t, std::unique_ptr<int32_t>> test_tree;
+
+    EXPECT_TRUE(test_tree.insert(std::make_pair(1, std::make_unique<int32_t>(10))).second);
+    EXPECT_TRUE(test_tree.emplace(2, std::make_unique<int32_t>(20)).second);
+    EXPECT_FALSE(test_tree.emplace(2, std::make_unique<int32_t>(21)).second);
+    EXPECT_EQ(*test_tree.find(2)->second, 20);
+
+    auto value = std::make_unique<int32_t>(30);
+    EXPECT_TRUE(test_tree.try_emplace(3, std::move(value)).second);
+    EXPECT_EQ(value, nullptr);
+
+    value = std::make_unique<int32_t>(31);
+    auto result = test_tree.try_emplace(3, std::move(value));
+    EXPECT_FALSE(result.second);
+    EXPECT_NE(value, nullptr); // args are untouched for an existing key
+    EXPECT_EQ(*result.first->second, 30);
+
+    EXPECT_FALSE(test_tree.insert_or_assign(3, std::make_unique<int32_t>(32)).second);
+    EXPECT_EQ(*test_tree.find(3)->second, 32);
+    EXPECT_TRUE(test_tree.insert_or_assign(4, std::make_unique<int32_t>(40)).second);
+
+    EXPECT_EQ(test_tree.size(), (size_t)4);
+}
+
+TEST(SplayTreeNodeHandle, MoveBetweenTrees)
+{
+    splay_tree<int32_t, std::string> tree1, tree2;
+
+    tree1.insert(std::make_pair(1, std::string("one")));
+    tree1.insert(std::make_pair(2, std::string("two")));
+    tree2.insert(std::make_pair(2, std::string("second two")));
+
+    auto nh = tree1.extract(1);
+    ASSERT_FALSE(nh.empty());
+    EXPECT_EQ(nh.key(), 1);
+    EXPECT_EQ(nh.mapped(), "one");
+
+    const std::string* address = &nh.mapped();
+
+    auto result = tree2.insert(std::move(nh));
+    EXPECT_TRUE(result.inserted);
+    EXPECT_TRUE(result.node.empty());
+    EXPECT_EQ(&result.position->second, address); // no copy
+
+    result = tree2.insert(tree1.extract(2));
+    EXPECT_FALSE(result.inserted);
+    EXPECT_EQ(result.node.mapped(), "two");
+    EXPECT_EQ(result.position->second, "second two");
+
+    EXPECT_TRUE(tree1.extract(3).empty());
+    EXPECT_TRUE(tree1.empty());
+    EXPECT_EQ(tree2.size(), (size_t)2);
+}
+
+TEST(SplayTreeErase, DefaultValue)
+{
+    splay_tree<int32_t, int32_t> test_tree;
+
+    test_tree.insert(std::make_pair(0, 0)); // equal to value_type()
+
+    EXPECT_EQ(test_tree.erase(0), (size_t)1);
+    EXPECT_EQ(test_tree.erase(0), (size_t)0);
+    EXPECT_TRUE(test_tree.empty());
+}
+
+TEST(SplayTreeErase, Iterator)
+{
+    splay_tree<int32_t, int32_t> test_tree;
+    std::map<int32_t, int32_t> std_tree;
+
+    srand(time(NULL));
+
+    const size_t N = 100;
+
+    for (size_t i = 0; i < N; ++i)
+    {
+        std::pair<const int32_t, int32_t> value = std::make_pair(rand() % N, rand());
+
+        test_tree.insert(value);
+        std_tree.insert(value);
+    }
+
+    for (size_t i = 0; i < N; ++i)
+    {
+        int32_t key = rand() % N;
+
+        auto it = test_tree.find(key);
+        auto std_it = std_tree.find(key);
+
+        ASSERT_EQ(it == test_tree.end(), std_it == std_tree.end());
+        if (it == test_tree.end())
+            continue;
+
+        it = test_tree.erase(it);
+        std_it = std_tree.erase(std_it);
+
+        ASSERT_EQ(it == test_tree.end(), std_it == std_tree.end());
+        if (it != test_tree.end())
+        {
+            EXPECT_EQ(it->first, std_it->first);
+        }
+        EXPECT_EQ(test_tree.size(), std_tree.size());
+    }
+
+    for (auto& x : std_tree)
+        EXPECT_EQ(test_tree.find(x.first)->second, x.second);
+}
+
+template<class SplayPolicy>
+class SplayTreePolicy : public ::testing::Test {};
+
+typedef ::testing::Types<full_splay_policy, semi_splay_policy, depth_threshold_splay_policy, sampled_splay_policy, counting_splay_policy<semi_splay_policy>, stats_splay_policy<sampled_splay_policy>> splay_policies;
+TYPED_TEST_SUITE(SplayTreePolicy, splay_policies);
+
+TYPED_TEST(SplayTreePolicy, RandomInsertFindErase)
+{
+    splay_tree<int32_t, int32_t, std::less<>, TypeParam> test_tree;
+    std::map<int32_t, int32_t> std_tree;
+
+    srand(time(NULL));
+
+    const size_t N = 1000;
+
+    for (size_t i = 0; i < N; ++i)
+    {
+        int32_t key = rand() % (N / 4);
+
+        switch (rand() % 3)
+        {
+        case 0: // insert
+        {
+            std::pair<const int32_t, int32_t> value = std::make_pair(key, rand());
+
+            EXPECT_EQ(test_tree.insert(value).second, std_tree.insert(value).second);
+
+            break;
+        }
+        case 1: // find
+        {
+            auto it = test_tree.find(key);
+
+            EXPECT_EQ(it != test_tree.end(), std_tree.count(key) == 1);
+            if (it != test_tree.end())
+            {
+                EXPECT_EQ(it->second, std_tree[key]);
             }
+
+            break;
+        }
+        case 2: // erase
+        {
+            EXPECT_EQ(test_tree.erase(key), std_tree.erase(key));
+
+            break;
         }
         }
+
+        EXPECT_EQ(test_tree.size(), std_tree.size());
     }
-}
\ No newline at end of file
+}
+
+TEST(SplayTreePolicyRotations, SequentialFind)
+{
+    const int32_t N = 1000;
+
+    std::vector<std::pair<int32_t, int32_t>> values;
+    for (int32_t i = 0; i < N; ++i)
+        values.push_back(std::make_pair(i, i));
+
+    splay_tree<int32_t, int32_t, std::less<>, full_splay_policy> full_tree(values.begin(), values.end());
+    splay_tree<int32_t, int32_t, std::less<>, semi_splay_policy> semi_tree(values.begin(), values.end());
+    splay_tree<int32_t, int32_t, std::less<>, depth_threshold_splay_policy> threshold_tree(values.begin(), values.end());
+    splay_tree<int32_t, int32_t, std::less<>, sampled_splay_policy> sampled_tree(values.begin(), values.end());
+
+    EXPECT_EQ(full_tree.rotations(), (size_t)0); // balanced build has no rotations
+
+    for (int32_t i = 0; i < N; ++i)
+    {
+        int32_t key = (i * 7919) % N;
+
+        full_tree.find(key);
+        semi_tree.find(key);
+        threshold_tree.find(key);
+        sampled_tree.find(key);
+    }
+
+    EXPECT_LT(semi_tree.rotations(), full_tree.rotations());
+    EXPECT_EQ(threshold_tree.rotations(), (size_t)0); // balanced tree is never deeper than 2 * log(n)
+    EXPECT_LT(sampled_tree.rotations(), full_tree.rotations());
+
+    full_tree.reset_rotations();
+    EXPECT_EQ(full_tree.rotations(), (size_t)0);
+}
+
+TEST(SplayTreeStats, BalancedAndSplayed)
+{
+    const int32_t N = 1023; // balanced build is a perfect tree of 10 levels
+
+    std::vector<std::pair<int32_t, int32_t>> values;
+    for (int32_t i = 0; i < N; ++i)
+        values.push_back(std::make_pair(i, i));
+
+    splay_tree<int32_t, int32_t, std::less<>, stats_splay_policy<depth_threshold_splay_policy>> balanced_tree(values.begin(), values.end());
+    splay_tree<int32_t, int32_t, std::less<>, stats_splay_policy<>> full_tree(values.begin(), values.end());
+    splay_tree<int32_t, int32_t> plain_tree(values.begin(), values.end());
+
+    for (int32_t i = 0; i < N; ++i)
+    {
+        balanced_tree.find(i);
+        full_tree.find((i * 7919) % N);
+        plain_tree.find(i);
+    }
+
+    // balanced tree is never splayed, every level is accessed once per node
+    splay_tree_stats stats = balanced_tree.stats();
+
+    EXPECT_EQ(stats.zig_l + stats.zig_r, (uint64_t)0);
+    EXPECT_EQ(stats.accesses, (uint64_t)N);
+    for (size_t d = 0; d < 10; ++d)
+        EXPECT_EQ(stats.depth_histogram[d], (uint64_t)1 << d);
+    EXPECT_EQ(stats.height, (size_t)10);
+    EXPECT_EQ(stats.node_count, (size_t)N);
+    EXPECT_GT(stats.allocated_bytes, N * sizeof(std::pair<const int32_t, int32_t>));
+
+    stats = full_tree.stats();
+
+    EXPECT_EQ(stats.zig_l + stats.zig_r, (uint64_t)full_tree.rotations());
+    EXPECT_GT(stats.zig_l, (uint64_t)0);
+    EXPECT_GT(stats.zig_r, (uint64_t)0);
+    EXPECT_EQ(stats.accesses, (uint64_t)N);
+    EXPECT_GE(stats.height, (size_t)10);
+
+    full_tree.insert(std::make_pair(N, N));
+    full_tree.reset_stats();
+    full_tree.insert(std::make_pair(N + 1, N + 1)); // right child of the root after the previous insert
+
+    stats = full_tree.stats();
+
+    EXPECT_EQ(stats.accesses, (uint64_t)1);
+    EXPECT_EQ(stats.depth_histogram[1], (uint64_t)1);
+    EXPECT_EQ(stats.zig_l, (uint64_t)0);
+    EXPECT_EQ(stats.zig_r, (uint64_t)1);
+    EXPECT_EQ(stats.node_count, (size_t)N + 2);
+
+    // counters are not collected without stats policy
+    stats = plain_tree.stats();
+
+    EXPECT_EQ(stats.accesses, (uint64_t)0);
+    EXPECT_EQ(stats.zig_l + stats.zig_r, (uint64_t)0);
+    EXPECT_EQ(stats.node_count, (size_t)N);
+    EXPECT_GE(stats.height, (size_t)10);
+}
+
+TEST(SplayTreeOptimize, SkewedAccesses)
+{
+    splay_tree<int32_t, int32_t, std::less<>, counting_splay_policy<>> test_tree;
+    std::map<int32_t, int32_t> std_tree;
+
+    srand(time(NULL));
+
+    const int32_t N = 1000;
+
+    for (int32_t i = 0; i < N; ++i)
+    {
+        int32_t key = rand() % (2 * N);
+
+        test_tree.insert(std::make_pair(key, i));
+        std_tree.insert(std::make_pair(key, i));
+    }
+
+    // the hot key gets more than half of the total weight
+    const int32_t hot = std_tree.begin()->first;
+    for (int32_t i = 0; i < 2 * N; ++i)
+    {
+        test_tree.find(hot);
+        test_tree.find(hot);
+        test_tree.find(hot);
+        test_tree.find(rand() % (2 * N));
+    }
+
+    test_tree.optimize();
+    test_tree.reset_rotations();
+
+    EXPECT_TRUE(test_tree.splaying_suspended());
+
+    for (int32_t key = -1; key <= 2 * N; ++key)
+    {
+        auto it = test_tree.find(key);
+        auto std_it = std_tree.find(key);
+
+        if (std_it == std_tree.end())
+            EXPECT_TRUE(it == test_tree.end());
+        else
+        {
+            ASSERT_TRUE(it != test_tree.end());
+            EXPECT_EQ(it->second, std_it->second);
+        }
+    }
+    EXPECT_EQ(test_tree.rotations(), (size_t)0);
+
+    auto std_it = std_tree.begin();
+    for (auto it = test_tree.begin(); it != test_tree.end(); ++it, ++std_it)
+    {
+        ASSERT_TRUE(std_it != std_tree.end());
+        EXPECT_EQ(it->first, std_it->first);
+    }
+    EXPECT_TRUE(std_it == std_tree.end());
+
+    // the hot key is the root: finding it after resume doesn't rotate
+    test_tree.resume_splaying();
+    test_tree.find(hot);
+    EXPECT_EQ(test_tree.rotations(), (size_t)0);
+
+    test_tree.reset_accesses();
+    test_tree.optimize();
+    EXPECT_EQ(test_tree.size(), std_tree.size());
+}
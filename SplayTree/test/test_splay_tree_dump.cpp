@@ -0,0 +1,139 @@
+#include "splay_tree_dump.h"
+#include <gtest/gtest.h>
+
+#include <map>
+#include <string>
+#include <sstream>
+#include <cstdio>
+#include <cstdint>
+#include <ctime>
+#include <cstdlib>
+
+
+struct point
+{
+    int16_t x;
+    int64_t y; // padding between x and y is not written
+};
+
+TEST(SplayTreeDumpLoad, StreamAndFile)
+{
+    splay_tree<int32_t, point> test_tree;
+    std::map<int32_t, point> std_tree;
+
+    srand(time(NULL));
+
+    const size_t N = 1000;
+
+    for (size_t i = 0; i < N; ++i)
+    {
+        std::pair<const int32_t, point> value = std::make_pair(rand() % (4 * N), point{ (int16_t)rand(), rand() });
+
+        test_tree.insert(value);
+        std_tree.insert(value);
+    }
+
+    // a buffer smaller than a record still holds one record
+    std::stringstream stream;
+    splay_tree_dump<int32_t, point>::dump(test_tree, stream, 1);
+
+    EXPECT_EQ(stream.str().size(), sizeof(splay_tree_dump_header) + std_tree.size() * (sizeof(int32_t) + sizeof(point)));
+
+    const std::string path = "test_splay_tree_dump.bin";
+    splay_tree_dump<int32_t, point>::dump(test_tree, path);
+
+    auto stream_tree = splay_tree_dump<int32_t, point>::load(stream, std::less<>{}, 100);
+    auto file_tree = splay_tree_dump<int32_t, point>::load(path);
+
+    std::remove(path.c_str());
+
+    for (auto* loaded : { &stream_tree, &file_tree })
+    {
+        ASSERT_EQ(loaded->size(), std_tree.size());
+        EXPECT_EQ(loaded->rotations(), (size_t)0);
+
+        auto std_it = std_tree.begin();
+        for (auto it = loaded->begin(); it != loaded->end(); ++it, ++std_it)
+        {
+            EXPECT_EQ(it->first, std_it->first);
+            EXPECT_EQ(it->second.x, std_it->second.x);
+            EXPECT_EQ(it->second.y, std_it->second.y);
+        }
+
+        // balanced build
+        size_t height = 0;
+        for (size_t n = loaded->size(); n > 0; n >>= 1)
+            ++height;
+        EXPECT_EQ(loaded->stats().height, height);
+
+        // the loaded tree is a usual splay tree
+        for (int32_t key = -1; key <= (int32_t)(4 * N); ++key)
+            EXPECT_EQ(loaded->find(key) != loaded->end(), std_tree.count(key) == 1);
+
+        EXPECT_EQ(loaded->erase(std_tree.begin()->first), (size_t)1);
+        EXPECT_TRUE(loaded->insert(std::make_pair(-5, point{ 1, 2 })).second);
+    }
+}
+
+TEST(SplayTreeDumpLoad, Empty)
+{
+    splay_tree<int64_t, int64_t> test_tree;
+
+    std::stringstream stream;
+    splay_tree_dump<int64_t, int64_t>::dump(test_tree, stream);
+
+    auto loaded = splay_tree_dump<int64_t, int64_t>::load(stream);
+
+    EXPECT_TRUE(loaded.empty());
+}
+
+TEST(SplayTreeDumpLoad, DamagedDump)
+{
+    splay_tree<int32_t, int32_t> test_tree;
+
+    for (int32_t i = 0; i < 100; ++i)
+        test_tree.insert(std::make_pair(i, -i));
+
+    std::stringstream stream;
+    splay_tree_dump<int32_t, int32_t>::dump(test_tree, stream);
+
+    const std::string dump = stream.str();
+
+    // truncated
+    {
+        std::stringstream in(dump.substr(0, dump.size() - 1));
+        EXPECT_THROW((splay_tree_dump<int32_t, int32_t>::load(in)), std::runtime_error);
+    }
+    {
+        std::stringstream in(dump.substr(0, 10));
+        EXPECT_THROW((splay_tree_dump<int32_t, int32_t>::load(in)), std::runtime_error);
+    }
+
+    // other magic
+    {
+        std::string damaged = dump;
+        damaged[0] = 'X';
+
+        std::stringstream in(damaged);
+        EXPECT_THROW((splay_tree_dump<int32_t, int32_t>::load(in)), std::runtime_error);
+    }
+
+    // other T
+    {
+        std::stringstream in(dump);
+        EXPECT_THROW((splay_tree_dump<int32_t, int64_t>::load(in)), std::runtime_error);
+    }
+
+    // mapped file: truncated and missing
+    const std::string path = "test_splay_tree_dump_damaged.bin";
+    {
+        std::ofstream out(path, std::ios::binary);
+        out.write(dump.data(), dump.size() - 1);
+    }
+
+    EXPECT_THROW((splay_tree_dump<int32_t, int32_t>::load(path)), std::runtime_error);
+
+    std::remove(path.c_str());
+
+    EXPECT_THROW((splay_tree_dump<int32_t, int32_t>::load(path)), std::runtime_error);
+}
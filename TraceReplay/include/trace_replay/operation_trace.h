@@ -0,0 +1,348 @@
+//
+// "operation_trace.h" is a library for recording operations of heap and splay_tree into compact binary traces
+//
+
+#pragma once
+
+#include "heap.h"
+#include "splay_tree.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <utility>
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+
+
+// Operation trace format
+//
+// A 24-byte header: magic "OPTRACE1", format version, traced structure (heap or splay_tree)
+// and number of operations, followed by operation records:
+//		* 1 byte - operation code (trace_op)
+//		* for operations with a key (push, insert, find, extract) - difference from the previous key
+//		  of the trace, zigzag-encoded as unsigned LEB128 varint (1 byte for differences in [-64, 63])
+// Keys are recorded as int64_t, so recorded Key (or heap's T) must be an integral type.
+// Integers of the header are in the byte order of the machine that wrote the trace
+//
+
+enum class trace_structure : uint32_t
+{
+    heap = 0,
+    splay_tree = 1
+};
+
+enum class trace_op : uint8_t
+{
+    push = 0,       // heap::push(key)
+    pop = 1,        // heap::pop()
+    top = 2,        // heap::top()
+    insert = 3,     // splay_tree::insert({ key, mapped })
+    find = 4,       // splay_tree::find(key)
+    extract = 5     // splay_tree::extract(key)
+};
+
+struct trace_record
+{
+    trace_op op;
+    int64_t key; // 0 for operations without a key
+};
+
+// Returns weather the operation has a key
+inline bool trace_op_has_key(trace_op op)
+{
+    return op != trace_op::pop && op != trace_op::top;
+}
+
+
+// Buffered writer of an operation trace file
+// The number of operations is written into the header by close() (or the destructor)
+class trace_writer
+{
+public:
+    trace_writer(const std::string& path, trace_structure structure, size_t buffer_size = 1 << 16);
+    trace_writer(const trace_writer&) = delete;
+    ~trace_writer();
+
+    trace_writer& operator= (const trace_writer&) = delete;
+
+    void record(trace_op op, int64_t key = 0);
+    void close();
+
+    uint64_t operations() const { return count; }
+
+private:
+    void flush();
+
+
+    std::ofstream out;
+    std::vector<unsigned char> buffer;
+    size_t used;
+
+    int64_t last_key;
+    uint64_t count;
+};
+
+// Buffered reader of an operation trace file
+class trace_reader
+{
+public:
+    trace_reader(const std::string& path, size_t buffer_size = 1 << 16);
+
+    bool next(trace_record& record);
+
+    trace_structure structure() const { return traced; }
+    uint64_t operations() const { return count; }
+
+private:
+    bool read_byte(unsigned char& byte);
+
+
+    std::ifstream in;
+    std::vector<unsigned char> buffer;
+    size_t pos, end;
+
+    trace_structure traced;
+    int64_t last_key;
+    uint64_t count;
+};
+
+
+// Heap that records push, pop and top into the trace
+template<class T, class Compare = std::less<>>
+class recording_heap
+{
+    static_assert(std::is_integral<T>::value, "recorded heap values must be integral");
+public:
+    recording_heap(trace_writer& trace, Compare comp = Compare{}) : h(comp), trace(trace) {}
+
+    void push(const T& value) { trace.record(trace_op::push, (int64_t)value); h.push(value); }
+    void pop() { trace.record(trace_op::pop); h.pop(); }
+    T top() const { trace.record(trace_op::top); return h.top(); }
+
+    bool empty() const { return h.empty(); }
+    size_t size() const { return h.size(); }
+
+    // Returns the heap itself, its operations are not recorded
+    heap<T, Compare>& container() { return h; }
+
+private:
+    heap<T, Compare> h;
+
+    trace_writer& trace;
+};
+
+// Splay tree that records insert, find and extract into the trace
+template<class Key, class T, class Compare = std::less<>, class SplayPolicy = full_splay_policy>
+class recording_splay_tree
+{
+    static_assert(std::is_integral<Key>::value, "recorded splay tree keys must be integral");
+public:
+    typedef splay_tree<Key, T, Compare, SplayPolicy> tree_type;
+
+    recording_splay_tree(trace_writer& trace, Compare comp = Compare{}) : tree(comp), trace(trace) {}
+
+    std::pair<typename tree_type::iterator, bool> insert(const typename tree_type::value_type& value)
+    {
+        trace.record(trace_op::insert, (int64_t)value.first);
+        return tree.insert(value);
+    }
+    typename tree_type::iterator find(const Key& key)
+    {
+        trace.record(trace_op::find, (int64_t)key);
+        return tree.find(key);
+    }
+    typename tree_type::node_handle extract(const Key& key)
+    {
+        trace.record(trace_op::extract, (int64_t)key);
+        return tree.extract(key);
+    }
+
+    typename tree_type::iterator end() const { return tree.end(); }
+    bool empty() const { return tree.empty(); }
+    size_t size() const { return tree.size(); }
+
+    // Returns the tree itself, its operations are not recorded
+    tree_type& container() { return tree; }
+
+private:
+    tree_type tree;
+
+    trace_writer& trace;
+};
+
+
+
+inline constexpr char trace_magic[8] = { 'O', 'P', 'T', 'R', 'A', 'C', 'E', '1' };
+inline constexpr uint32_t trace_version = 1;
+inline constexpr size_t trace_header_size = 24;
+inline constexpr size_t trace_count_offset = 16;
+
+// Creates the trace file and writes its header
+// Throws std::runtime_error if the file can't be created
+inline trace_writer::trace_writer(const std::string& path, trace_structure structure, size_t buffer_size)
+    : out(path, std::ios::binary | std::ios::trunc), buffer(std::max(buffer_size, (size_t)16)), used(0), last_key(0), count(0)
+{
+    if (!out)
+        throw std::runtime_error("trace_writer can't create " + path);
+
+    const uint32_t structure_code = (uint32_t)structure;
+    const uint64_t unknown_count = 0;
+
+    out.write(trace_magic, sizeof(trace_magic));
+    out.write(reinterpret_cast<const char*>(&trace_version), sizeof(trace_version));
+    out.write(reinterpret_cast<const char*>(&structure_code), sizeof(structure_code));
+    out.write(reinterpret_cast<const char*>(&unknown_count), sizeof(unknown_count));
+}
+
+inline trace_writer::~trace_writer()
+{
+    try
+    {
+        close();
+    }
+    catch (...)
+    {
+    }
+}
+
+// Appends the operation, the key is ignored for operations without a key
+// O(1)
+inline void trace_writer::record(trace_op op, int64_t key)
+{
+    // an operation takes at most 11 bytes
+    if (buffer.size() - used < 11)
+        flush();
+
+    buffer[used++] = (unsigned char)op;
+
+    if (trace_op_has_key(op))
+    {
+        const int64_t delta = (int64_t)((uint64_t)key - (uint64_t)last_key);
+        uint64_t zigzag = ((uint64_t)delta << 1) ^ (uint64_t)(delta >> 63);
+
+        while (zigzag >= 0x80)
+        {
+            buffer[used++] = (unsigned char)(zigzag | 0x80);
+            zigzag >>= 7;
+        }
+        buffer[used++] = (unsigned char)zigzag;
+
+        last_key = key;
+    }
+
+    ++count;
+}
+
+// Writes buffered operations and the number of operations, then closes the file
+// Throws std::runtime_error if writing fails
+inline void trace_writer::close()
+{
+    if (!out.is_open())
+        return;
+
+    flush();
+
+    out.seekp(trace_count_offset);
+    out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    out.close();
+
+    if (!out)
+        throw std::runtime_error("trace_writer failed to write the trace");
+}
+
+inline void trace_writer::flush()
+{
+    out.write(reinterpret_cast<const char*>(buffer.data()), used);
+    used = 0;
+}
+
+// Opens the trace file and reads its header
+// Throws std::runtime_error if the file can't be read or it is not an operation trace
+inline trace_reader::trace_reader(const std::string& path, size_t buffer_size)
+    : in(path, std::ios::binary), buffer(std::max(buffer_size, (size_t)16)), pos(0), end(0), last_key(0)
+{
+    if (!in)
+        throw std::runtime_error("trace_reader can't open " + path);
+
+    char header[trace_header_size];
+
+    if (!in.read(header, sizeof(header)) || std::memcmp(header, trace_magic, sizeof(trace_magic)) != 0)
+        throw std::runtime_error("trace_reader: " + path + " is not an operation trace");
+
+    uint32_t version, structure_code;
+    std::memcpy(&version, header + 8, sizeof(version));
+    std::memcpy(&structure_code, header + 12, sizeof(structure_code));
+    std::memcpy(&count, header + trace_count_offset, sizeof(count));
+
+    if (version != trace_version)
+        throw std::runtime_error("trace_reader: unsupported trace version");
+
+    if (structure_code > (uint32_t)trace_structure::splay_tree)
+        throw std::runtime_error("trace_reader: unknown traced structure");
+
+    traced = (trace_structure)structure_code;
+}
+
+// Reads the next operation
+// Returns false at the end of the trace, throws std::runtime_error if the trace is damaged
+// O(1)
+inline bool trace_reader::next(trace_record& record)
+{
+    unsigned char byte;
+
+    if (!read_byte(byte))
+        return false;
+
+    if (byte > (unsigned char)trace_op::extract)
+        throw std::runtime_error("trace_reader: unknown operation code");
+
+    record.op = (trace_op)byte;
+    record.key = 0;
+
+    if (trace_op_has_key(record.op))
+    {
+        uint64_t zigzag = 0;
+
+        for (int shift = 0; ; shift += 7)
+        {
+            if (shift > 63 || !read_byte(byte))
+                throw std::runtime_error("trace_reader: the trace is damaged");
+
+            zigzag |= (uint64_t)(byte & 0x7f) << shift;
+
+            if ((byte & 0x80) == 0)
+                break;
+        }
+
+        const int64_t delta = (int64_t)(zigzag >> 1) ^ -(int64_t)(zigzag & 1);
+
+        last_key = (int64_t)((uint64_t)last_key + (uint64_t)delta);
+        record.key = last_key;
+    }
+
+    return true;
+}
+
+inline bool trace_reader::read_byte(unsigned char& byte)
+{
+    if (pos == end)
+    {
+        in.read(reinterpret_cast<char*>(buffer.data()), buffer.size());
+
+        pos = 0;
+        end = (size_t)in.gcount();
+
+        if (end == 0)
+            return false;
+    }
+
+    byte = buffer[pos++];
+
+    return true;
+}
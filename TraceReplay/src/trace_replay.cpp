@@ -0,0 +1,259 @@
+//
+// "trace_replay" replays an operation trace (see "operation_trace.h") against implementations
+// of the traced structure and reports throughput, latency percentiles and memory high-water mark
+//
+// Usage: trace_replay <trace file> [variant ...]
+// Without variants all variants of the traced structure are replayed:
+//		* heap traces - heap, std_priority_queue
+//		* splay_tree traces - full_splay, semi_splay, depth_threshold_splay, sampled_splay, std_map, std_unordered_map
+//
+
+#include "operation_trace.h"
+
+#include <map>
+#include <unordered_map>
+#include <queue>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include <functional>
+#include <iostream>
+#include <iomanip>
+#include <new>
+#include <cstdlib>
+#include <cstdint>
+
+
+// Memory accounting of the whole program: every allocation through operator new keeps its size
+// in a header before the block. The replay is single-threaded, so the counters are plain variables
+// (GCC inlines the replaced operators into library code and then warns about the header offset)
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#pragma GCC diagnostic ignored "-Warray-bounds"
+#endif
+
+static size_t live_bytes = 0;
+static size_t peak_bytes = 0;
+
+static const size_t allocation_header = alignof(std::max_align_t);
+
+void* operator new(size_t size)
+{
+    char* block = static_cast<char*>(std::malloc(size + allocation_header));
+
+    if (block == nullptr)
+        throw std::bad_alloc();
+
+    *reinterpret_cast<size_t*>(block) = size;
+
+    live_bytes += size;
+    peak_bytes = std::max(peak_bytes, live_bytes);
+
+    return block + allocation_header;
+}
+
+void operator delete(void* p) noexcept
+{
+    if (p == nullptr)
+        return;
+
+    char* block = static_cast<char*>(p) - allocation_header;
+
+    live_bytes -= *reinterpret_cast<size_t*>(block);
+
+    std::free(block);
+}
+
+void* operator new[](size_t size) { return operator new(size); }
+void operator delete[](void* p) noexcept { operator delete(p); }
+void operator delete(void* p, size_t) noexcept { operator delete(p); }
+void operator delete[](void* p, size_t) noexcept { operator delete(p); }
+
+
+struct replay_result
+{
+    double seconds = 0;
+    size_t peak_bytes = 0;          // high-water mark of memory allocated by the replayed structure
+    int64_t checksum = 0;           // sum of operation results, equal for correct implementations
+    std::vector<uint64_t> latencies; // nanoseconds of every operation, sorted
+};
+
+// Runs one heap operation and returns its result (the top value, 1 for a push, 0 for an operation on empty heap)
+template<class Heap>
+static int64_t run_heap_operation(Heap& h, const trace_record& record)
+{
+    switch (record.op)
+    {
+    case trace_op::push:
+        h.push(record.key);
+        return 1;
+    case trace_op::pop:
+        if (h.empty())
+            return 0;
+        h.pop();
+        return 1;
+    case trace_op::top:
+        return h.empty() ? 0 : (int64_t)h.top();
+    default:
+        throw std::runtime_error("not a heap operation in the trace");
+    }
+}
+
+// Runs one map operation and returns its result (1 if the key was inserted, found or extracted, 0 otherwise)
+template<class Map>
+static int64_t run_map_operation(Map& map, const trace_record& record)
+{
+    switch (record.op)
+    {
+    case trace_op::insert:
+        return map.insert(std::make_pair(record.key, record.key)).second;
+    case trace_op::find:
+        return map.find(record.key) != map.end();
+    case trace_op::extract:
+        return !map.extract(record.key).empty();
+    default:
+        throw std::runtime_error("not a splay_tree operation in the trace");
+    }
+}
+
+// Replays the trace twice on new containers: untimed operations for throughput and memory,
+// then every operation timed for latencies (they include the cost of two clock reads)
+template<class Container, class Operation>
+static replay_result replay(const std::vector<trace_record>& trace, Operation operation)
+{
+    replay_result result;
+    result.latencies.resize(trace.size());
+
+    {
+        const size_t base_bytes = live_bytes;
+        peak_bytes = live_bytes;
+
+        auto start = std::chrono::steady_clock::now();
+        {
+            Container container;
+
+            for (const trace_record& record : trace)
+                result.checksum += operation(container, record);
+        }
+        auto finish = std::chrono::steady_clock::now();
+
+        result.seconds = std::chrono::duration<double>(finish - start).count();
+        result.peak_bytes = peak_bytes - base_bytes;
+    }
+
+    {
+        Container container;
+
+        for (size_t i = 0; i < trace.size(); ++i)
+        {
+            auto start = std::chrono::steady_clock::now();
+            operation(container, trace[i]);
+            auto finish = std::chrono::steady_clock::now();
+
+            result.latencies[i] = (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(finish - start).count();
+        }
+    }
+
+    std::sort(result.latencies.begin(), result.latencies.end());
+
+    return result;
+}
+
+static void print_result(const std::string& variant, const replay_result& result)
+{
+    const std::vector<uint64_t>& l = result.latencies;
+
+    auto percentile = [&l](double p) { return l.empty() ? 0 : l[std::min((size_t)(p * l.size()), l.size() - 1)]; };
+
+    std::cout << std::left << std::setw(24) << variant << std::right
+        << std::setw(14) << std::fixed << std::setprecision(0) << (result.seconds > 0 ? l.size() / result.seconds : 0.0)
+        << std::setw(10) << percentile(0.5)
+        << std::setw(10) << percentile(0.9)
+        << std::setw(10) << percentile(0.99)
+        << std::setw(10) << percentile(0.999)
+        << std::setw(12) << (l.empty() ? 0 : l.back())
+        << std::setw(16) << result.peak_bytes
+        << std::setw(14) << result.checksum << "\n";
+}
+
+typedef std::function<replay_result(const std::vector<trace_record>&)> replayer;
+
+template<class Heap>
+static replayer heap_replayer()
+{
+    return [](const std::vector<trace_record>& trace) { return replay<Heap>(trace, run_heap_operation<Heap>); };
+}
+
+template<class Map>
+static replayer map_replayer()
+{
+    return [](const std::vector<trace_record>& trace) { return replay<Map>(trace, run_map_operation<Map>); };
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::cerr << "usage: trace_replay <trace file> [variant ...]\n";
+        return 2;
+    }
+
+    try
+    {
+        trace_reader reader(argv[1]);
+
+        std::vector<std::pair<std::string, replayer>> variants;
+
+        if (reader.structure() == trace_structure::heap)
+        {
+            variants.emplace_back("heap", heap_replayer<heap<int64_t>>());
+            variants.emplace_back("std_priority_queue", heap_replayer<std::priority_queue<int64_t>>());
+        }
+        else
+        {
+            variants.emplace_back("full_splay", map_replayer<splay_tree<int64_t, int64_t, std::less<>, full_splay_policy>>());
+            variants.emplace_back("semi_splay", map_replayer<splay_tree<int64_t, int64_t, std::less<>, semi_splay_policy>>());
+            variants.emplace_back("depth_threshold_splay", map_replayer<splay_tree<int64_t, int64_t, std::less<>, depth_threshold_splay_policy>>());
+            variants.emplace_back("sampled_splay", map_replayer<splay_tree<int64_t, int64_t, std::less<>, sampled_splay_policy>>());
+            variants.emplace_back("std_map", map_replayer<std::map<int64_t, int64_t>>());
+            variants.emplace_back("std_unordered_map", map_replayer<std::unordered_map<int64_t, int64_t>>());
+        }
+
+        std::vector<std::string> selected(argv + 2, argv + argc);
+
+        for (const std::string& name : selected)
+            if (std::none_of(variants.begin(), variants.end(), [&name](const auto& v) { return v.first == name; }))
+                throw std::runtime_error("unknown variant " + name + " for this trace");
+
+        std::vector<trace_record> trace;
+        trace.reserve(reader.operations());
+
+        trace_record record;
+        while (reader.next(record))
+            trace.push_back(record);
+
+        std::cout << trace.size() << " operations of " << (reader.structure() == trace_structure::heap ? "heap" : "splay_tree") << "\n";
+        std::cout << std::left << std::setw(24) << "variant" << std::right
+            << std::setw(14) << "ops/s"
+            << std::setw(10) << "p50 ns"
+            << std::setw(10) << "p90 ns"
+            << std::setw(10) << "p99 ns"
+            << std::setw(10) << "p99.9 ns"
+            << std::setw(12) << "max ns"
+            << std::setw(16) << "peak bytes"
+            << std::setw(14) << "checksum" << "\n";
+
+        for (auto& variant : variants)
+            if (selected.empty() || std::find(selected.begin(), selected.end(), variant.first) != selected.end())
+                print_result(variant.first, variant.second(trace));
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "trace_replay: " << e.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
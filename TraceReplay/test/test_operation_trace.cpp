@@ -0,0 +1,176 @@
+#include "operation_trace.h"
+#include <gtest/gtest.h>
+
+#include <map>
+#include <queue>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <iterator>
+#include <cstdio>
+#include <cstdint>
+#include <ctime>
+#include <cstdlib>
+
+
+TEST(OperationTraceRecordRead, Heap)
+{
+    const std::string path = "test_operation_trace_heap.bin";
+
+    std::vector<trace_record> expected;
+
+    srand(time(NULL));
+
+    {
+        trace_writer writer(path, trace_structure::heap);
+        recording_heap<int32_t> test_heap(writer);
+        std::priority_queue<int32_t> std_heap;
+
+        for (size_t i = 0; i < 1000; ++i)
+        {
+            if (rand() % 3 != 0 || std_heap.empty())
+            {
+                int32_t value = rand() - RAND_MAX / 2;
+
+                test_heap.push(value);
+                std_heap.push(value);
+                expected.push_back({ trace_op::push, value });
+            }
+            else if (rand() % 2 == 0)
+            {
+                EXPECT_EQ(test_heap.top(), std_heap.top());
+                expected.push_back({ trace_op::top, 0 });
+            }
+            else
+            {
+                test_heap.pop();
+                std_heap.pop();
+                expected.push_back({ trace_op::pop, 0 });
+            }
+        }
+
+        EXPECT_EQ(writer.operations(), (uint64_t)expected.size());
+    }
+
+    trace_reader reader(path);
+
+    EXPECT_EQ(reader.structure(), trace_structure::heap);
+    EXPECT_EQ(reader.operations(), (uint64_t)expected.size());
+
+    trace_record record;
+    for (const trace_record& e : expected)
+    {
+        ASSERT_TRUE(reader.next(record));
+        EXPECT_EQ(record.op, e.op);
+        EXPECT_EQ(record.key, e.key);
+    }
+    EXPECT_FALSE(reader.next(record));
+
+    std::remove(path.c_str());
+}
+
+TEST(OperationTraceRecordRead, SplayTree)
+{
+    const std::string path = "test_operation_trace_splay_tree.bin";
+
+    std::vector<trace_record> expected;
+
+    srand(time(NULL));
+
+    {
+        // a small buffer is flushed many times
+        trace_writer writer(path, trace_structure::splay_tree, 32);
+        recording_splay_tree<int64_t, int32_t> test_tree(writer);
+        std::map<int64_t, int32_t> std_tree;
+
+        for (size_t i = 0; i < 1000; ++i)
+        {
+            // small and huge keys: 1-byte and 10-byte deltas
+            int64_t key = (rand() % 2 == 0) ? rand() % 100 : (int64_t)rand() * (INT64_MAX / RAND_MAX) * ((rand() % 2) ? 1 : -1);
+
+            switch (rand() % 3)
+            {
+            case 0:
+                EXPECT_EQ(test_tree.insert(std::make_pair(key, 1)).second, std_tree.insert(std::make_pair(key, 1)).second);
+                expected.push_back({ trace_op::insert, key });
+                break;
+            case 1:
+                EXPECT_EQ(test_tree.find(key) != test_tree.end(), std_tree.count(key) == 1);
+                expected.push_back({ trace_op::find, key });
+                break;
+            case 2:
+                EXPECT_EQ(test_tree.extract(key).empty(), std_tree.erase(key) == 0);
+                expected.push_back({ trace_op::extract, key });
+                break;
+            }
+        }
+
+        EXPECT_EQ(test_tree.size(), std_tree.size());
+    }
+
+    trace_reader reader(path, 16);
+
+    EXPECT_EQ(reader.structure(), trace_structure::splay_tree);
+    EXPECT_EQ(reader.operations(), (uint64_t)expected.size());
+
+    trace_record record;
+    for (const trace_record& e : expected)
+    {
+        ASSERT_TRUE(reader.next(record));
+        EXPECT_EQ(record.op, e.op);
+        EXPECT_EQ(record.key, e.key);
+    }
+    EXPECT_FALSE(reader.next(record));
+
+    std::remove(path.c_str());
+}
+
+TEST(OperationTraceRead, DamagedTrace)
+{
+    const std::string path = "test_operation_trace_damaged.bin";
+
+    {
+        trace_writer writer(path, trace_structure::splay_tree);
+        writer.record(trace_op::insert, 1000000);
+    }
+
+    std::string trace;
+    {
+        std::ifstream in(path, std::ios::binary);
+        trace.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    ASSERT_EQ(trace.size(), trace_header_size + 4); // code and 3-byte varint
+
+    auto write = [&path](const std::string& content)
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(content.data(), content.size());
+    };
+
+    // cut varint
+    write(trace.substr(0, trace.size() - 1));
+    {
+        trace_reader reader(path);
+        trace_record record;
+
+        EXPECT_THROW(reader.next(record), std::runtime_error);
+    }
+
+    // unknown operation
+    write(trace.substr(0, trace_header_size) + std::string(1, (char)100));
+    {
+        trace_reader reader(path);
+        trace_record record;
+
+        EXPECT_THROW(reader.next(record), std::runtime_error);
+    }
+
+    // other magic
+    write("X" + trace.substr(1));
+    EXPECT_THROW(trace_reader reader(path), std::runtime_error);
+
+    std::remove(path.c_str());
+
+    EXPECT_THROW(trace_reader reader(path), std::runtime_error);
+}